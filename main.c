@@ -12,34 +12,109 @@
  * argv[0]: "./<programın_adı>"
  * argv[1]: Server'ın dosya alışverişinde kullanacağı ana dizin
  * argv[2]: Port numarası
+ * Ana dizinden önce isteğe bağlı seçenekler verilebilir:
+ * -b <bayt>: Client'ın blksize seçeneğiyle isteyebileceği en büyük blok boyutu (varsayılan 65464)
+ * -d <mod>: WRQ ile alınan dosyaların diske kalıcı yazılma modu: "never" (fsync yapılmaz), "end" (transfer sonunda fsync,
+ *    varsayılan) ya da "periodic" (her 16 MB'da ve transfer sonunda fsync)
+ * -g: Penceredeki eşit boyutlu DATA paketleri UDP GSO (UDP_SEGMENT) ile tek seferde gönderilir
+ * -l <seviye>: Kayıt (log) seviyesi: "error", "warning", "info" (varsayılan) ya da "debug"
+ * -M <yol>: Sayaçların (metrics) düz metin olarak okunabileceği Unix soketinin yolu (örn. socat - UNIX-CONNECT:<yol>)
+ * -m <MB>: Okunan dosyaların bellek eşlemelerinin tutulduğu önbelleğin boyut sınırı (varsayılan 1024)
+ * -n <sayı>: Önbellekte tutulabilecek en fazla dosya sayısı (varsayılan 1024)
+ * -q <MB>: WRQ ile yüklenebilecek en büyük dosya boyutu (varsayılan 0: sınırsız)
+ * -s <sayı>: Aynı anda yürütülebilecek en fazla transfer oturumu sayısı (varsayılan 4096); worker'lara eşit bölünür
+ * -t <sayı>: Olay döngüsü (worker) sayısı (varsayılan 1; 0: kullanılabilir işlemci sayısı). Her worker kendi işlemcisine
+ *    sabitlenir ve SO_REUSEPORT ile aynı portu paylaşan kendi dinleme soketini kullanır; çekirdek gelen istekleri
+ *    worker'lara dağıtır ve bir oturum baştan sona onu açan worker'da yürütülür. Önbellek sınırları (-m, -n) worker başınadır.
+ * -w <sayı>: Client'ın windowsize seçeneğiyle isteyebileceği en büyük pencere boyutu (varsayılan 64)
+ *
+ * Paket başına izleme kayıtları (debug seviyesinde) varsayılan olarak derlenmez; -DTFTP_TRACE ile derlendiğinde açılır.
  * */
 
+#define	_GNU_SOURCE		// sendmmsg(), recvmmsg() ve struct mmsghdr tanımları için
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <inttypes.h>
+#include <limits.h>
 #include <string.h>
 #include <signal.h>
+#include <stdarg.h>
+#include <stdatomic.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <netdb.h>
 #include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/errno.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <sys/time.h>
 #include <sys/types.h>
-#include <sys/wait.h>
+#include <sys/uio.h>
+#include <time.h>
 #include <unistd.h>
 
 //Önişlemci Direktifleri
 #define	SOCKET_DOMAIN_ADDR		INADDR_ANY	// Soketin bağlanacağı protokol ailesinin seçimi (Local için: AF_LOCAL)
-#define	RECEIVE_TIMEOUT_SEC 	5 			// Saniye cinsinden zaman aşımı seçimi
+#define	RECEIVE_TIMEOUT_SEC 	5 			// Saniye cinsinden zaman aşımı seçimi (yeniden gönderim süresinin üst sınırı)
 #define	RECEIVE_TIMEOUT_USEC	0			// Mikrosaniye cinsinden zaman aşımı seçimi
+#define	TFTP_RTO_INITIAL		1000000		// RTT ölçümü yapılmadan önceki yeniden gönderim süresi (mikrosaniye, RFC 6298)
+#define	TFTP_RTO_MINIMUM		5000		// Yeniden gönderim süresinin alt sınırı (mikrosaniye)
+#define	TFTP_RTO_MAXIMUM		(RECEIVE_TIMEOUT_SEC * 1000000 + RECEIVE_TIMEOUT_USEC)	// Yeniden gönderim süresinin üst sınırı (mikrosaniye)
+#define	TFTP_CLOCK_GRANULARITY	1000		// Zamanlayıcı çözünürlüğü (mikrosaniye); RTTVAR'ın alt sınırı olarak kullanılır
+#define	TFTP_TIMEOUT_MAXIMUM	255			// timeout seçeneği ile istenebilecek en büyük zaman aşımı (saniye, RFC 2349)
 #define	TFTP_DATA_DEFAULT		512			// TFTP paketlerinin barındırabileceği maksimum veri boyutu (bayt)
 #define	TFTP_DATA_MINIMUM		4			// TFTP Data paketlerinin sahip olabileceği en düşük boyut (bayt cinsinden)
+#define	TFTP_BLKSIZE_MINIMUM	8			// blksize seçeneği ile istenebilecek en küçük blok boyutu (RFC 2348)
+#define	TFTP_BLKSIZE_MAXIMUM	65464		// blksize seçeneği ile istenebilecek en büyük blok boyutu (RFC 2348)
+#define	TFTP_WINDOWSIZE_MAXIMUM	65535		// windowsize seçeneği ile istenebilecek en büyük pencere boyutu (RFC 7440)
+#define	TFTP_WINDOWSIZE_LIMIT	64			// windowsize seçeneği için server sınırının varsayılan değeri
+#define	TFTP_SEND_BATCH			64			// Tek sistem çağrısıyla (sendmmsg/GSO) gönderilecek en fazla DATA paketi sayısı
+#define	TFTP_RECV_BATCH			32			// Dinleme soketinden tek sistem çağrısıyla (recvmmsg) alınacak en fazla istek sayısı
+#define	TFTP_GSO_MAXIMUM		65000		// UDP GSO ile tek seferde gönderilecek toplam verinin sınırı (bayt)
+#define	TFTP_FILEMAP_LIMIT_MB	1024		// Bellek eşlemli dosya önbelleğinin varsayılan boyut sınırı (MB)
+#define	TFTP_FILEMAP_ENTRIES	1024		// Bellek eşlemli dosya önbelleğinde tutulabilecek varsayılan en fazla dosya sayısı
+#define	TFTP_FILEMAP_BUCKETS	256			// Dosya önbelleğinin inode'a göre arama tablosundaki kova (bucket) sayısı
+#define	TFTP_WRITE_CHUNK		(256 * 1024)	// WRQ'da diske tek pwrite() ile yazılan parçanın boyutu (bayt, sayfa boyutunun katı)
+#define	TFTP_WRITE_POOL			256			// Tüm WRQ oturumlarının paylaştığı yazma havuzundaki en fazla parça sayısı
+#define	TFTP_SYNC_PERIOD_MB		16			// "periodic" modunda fdatasync() çağrıları arasında yazılan veri miktarı (MB)
+#define	TFTP_OACK_MAXIMUM		256			// OACK paketi için oturumda ayrılan tamponun boyutu (bayt)
 #define	TFTP_RETRY_NUMBER		5 			// Paket transferinde problem yaşandığında yapılacak maksimum tekrar deneme sayısı
+#define	TFTP_SESSION_DEFAULT	4096		// Aynı anda yürütülebilecek transfer oturumu sayısının varsayılan değeri
+#define	TFTP_SESSION_MAXIMUM	65536		// İzin verilen en yüksek eşzamanlı oturum sayısı
+#define	TFTP_EVENT_BATCH		256			// epoll_wait() ile tek seferde alınacak en fazla olay sayısı
+#define	TFTP_LOG_RING			4096		// Kayıt halkasındaki (ring buffer) kayıt sayısı (2'nin kuvveti)
+#define	TFTP_LOG_LINE			512			// Bir kaydın en fazla uzunluğu (bayt); uzun kayıtlar kesilir
+#define	TFTP_LOG_FLUSH_MS		10			// Halka boşken kayıt thread'inin bekleme süresi (milisaniye)
+#define	TFTP_METRICS_SLOTS		64			// Sayaç bloklarının sayısı (her olay döngüsü thread'i kendi bloğunu günceller)
+#define	TFTP_WORKER_MAXIMUM		TFTP_METRICS_SLOTS	// En fazla worker (olay döngüsü thread'i) sayısı
+#define	TFTP_HISTOGRAM_BUCKETS	24			// Histogramların 2'nin kuvveti sınırlı kova sayısı
+#define	TFTP_ERROR_CODES		9			// Sayılan TFTP hata kodları (0-8); diğer kodlar ayrı sayılır
+#define	TFTP_METRICS_OUTPUT		(32 * 1024)	// Sayaç çıktısının hazırlandığı tamponun boyutu (bayt)
 #define	EXIT_SUCCESS			0			// Başarılı sonlandırmayı bildirmek için exit() fonksiyonunda kullanılır
 #define	EXIT_FAILURE			1			// Anormal sonlandırmayı bildirmek için exit() fonksiyonunda kullanılır
 
+// Çalışan thread'in sayaç bloğundaki alanın artırılması. Her blok yalnızca kendi thread'i tarafından yazıldığından kilitli (atomik
+// toplama) işlem gerekmez; okuma, yazma ve okuyucu thread'lerle yarış olmaması için relaxed atomik erişimle yapılır.
+#define	TFTP_METRIC_ADD(field, value)	atomic_store_explicit(&threadMetrics->field, \
+		atomic_load_explicit(&threadMetrics->field, memory_order_relaxed) + (value), memory_order_relaxed)
+
+#ifdef TFTP_TRACE		// Paket başına izleme kayıtları yalnızca -DTFTP_TRACE ile derlenir
+#define	TFTP_LOG_TRACE(...)		tftp_log(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define	TFTP_LOG_TRACE(...)		((void) 0)
+#endif
+
 // TFTP Paketleri İçin Opcode Tanımlamaları
 enum opcode {
 	RRQ = 1,	// Read Request (Okuma İsteği)
@@ -47,6 +122,7 @@ enum opcode {
 	DATA,	// Data (Veri)
 	ACK,		// Acknowledgment (Alındı, Geri Bildirim)
 	ERROR,	// Hata
+	OACK,	// Option Acknowledgment (Seçenek Onayı, RFC 2347)
 };
 
 //TFTP Transfer Modu Tanımlamaları
@@ -85,408 +161,2353 @@ typedef union {
 
 } tftpMessage;
 
+// RRQ'larda okunan dosyaların bellek eşlemesi (mmap). Aynı dosyayı okuyan tüm oturumlar tek eşlemeyi paylaşır; DATA paketleri
+// doğrudan eşlenmiş sayfalardan gönderilir. Kullanılmayan eşlemeler, önbellek sınırları aşıldığında en eskisinden (LRU) silinir.
+typedef struct tftpFileMap {
+	dev_t device;						// Dosyanın bulunduğu aygıt
+	ino_t inode;						// Dosyanın inode numarası (aygıt ile birlikte önbellek anahtarı)
+	struct timespec modifyTime;			// Eşleme anındaki son değişiklik zamanı (dosyanın değiştiğinin anlaşılması için)
+	uint8_t *data;						// Eşlenmiş dosya içeriği
+	size_t size;						// Dosya boyutu (bayt)
+	unsigned int refCount;				// Eşlemeyi kullanan oturum sayısı (0 ise eşleme silinebilir)
+	int stale;							// Dosya diskte değiştiyse 1; eşleme yeni isteklere verilmez, son kullanıcıyla birlikte silinir
+	struct tftpFileMap *hashNext;		// Arama tablosunda aynı kovadaki sonraki eleman
+	struct tftpFileMap *prev;			// LRU listesindeki önceki (daha yeni kullanılan) eleman
+	struct tftpFileMap *next;			// LRU listesindeki sonraki (daha eski kullanılan) eleman
+} tftpFileMap;
+
+// Kayıt seviyeleri (-l ile seçilen seviyeden ayrıntılı kayıtlar üretilmez)
+enum logLevel {
+	LOG_LEVEL_ERROR = 1,	// Sistem çağrısı hataları
+	LOG_LEVEL_WARNING,		// Reddedilen istekler, beklenmeyen paketler
+	LOG_LEVEL_INFO,			// İstekler ve transfer özetleri
+	LOG_LEVEL_DEBUG,		// Paket başına izleme (-DTFTP_TRACE)
+};
+
+// Kayıt halkasındaki bir kayıt. sequence, kaydın halkadaki durumunu belirtir: konum değerine eşitse yazılabilir,
+// konum + 1 ise yazılmış ve kayıt thread'inin okumasına hazırdır.
+typedef struct tftpLogRecord {
+	atomic_size_t sequence;
+	uint64_t time;						// Kaydın oluşturulduğu an (gerçek zaman, mikrosaniye)
+	enum logLevel level;
+	char text[TFTP_LOG_LINE];			// Kaydın metni ("anahtar=değer" alanları)
+} tftpLogRecord;
+
+// Bir olay döngüsü thread'inin sayaçları. Sayaçlar, çıktı istendiğinde tüm blokların toplanmasıyla hesaplanır. Blok, başka
+// thread'lerin bloklarıyla aynı önbellek satırını paylaşmaması için hizalanır.
+typedef struct tftpMetrics {
+	atomic_uint_least64_t sessionsActive;						// Aktif oturum sayısı (artış ve azalışların toplamı)
+	atomic_uint_least64_t transfersStarted[2];					// Başlatılan transferler (RRQ, WRQ)
+	atomic_uint_least64_t transfersCompleted[2];				// Başarıyla tamamlanan transferler
+	atomic_uint_least64_t transfersFailed[2];					// Başarısız sonlanan transferler
+	atomic_uint_least64_t requestsRejected;						// Oturum oluşturulmadan reddedilen istekler
+	atomic_uint_least64_t bytesSent;							// Gönderilen DATA verisi (yeniden gönderimler dahil, bayt)
+	atomic_uint_least64_t bytesReceived;						// Alınan DATA verisi (bayt)
+	atomic_uint_least64_t packetsSent;							// Gönderilen DATA paketleri
+	atomic_uint_least64_t packetsReceived;						// Alınan DATA paketleri
+	atomic_uint_least64_t retransmits;							// Yeniden gönderimler (zaman aşımı ve kayıp bildirimi)
+	atomic_uint_least64_t timeouts;								// Zaman aşımıyla sonlanan transferler
+	atomic_uint_least64_t errorsSent[TFTP_ERROR_CODES + 1];		// Gönderilen ERROR paketleri (hata koduna göre, son eleman diğer kodlar)
+	atomic_uint_least64_t durationBuckets[TFTP_HISTOGRAM_BUCKETS];	// Transfer süresi histogramı (milisaniye, kova i: < 2^i)
+	atomic_uint_least64_t durationSum;							// Transfer sürelerinin toplamı (mikrosaniye)
+	atomic_uint_least64_t rttBuckets[TFTP_HISTOGRAM_BUCKETS];	// RTT ölçümleri histogramı (mikrosaniye, kova i: < 2^i)
+	atomic_uint_least64_t rttSum;								// RTT ölçümlerinin toplamı (mikrosaniye)
+} __attribute__((aligned(64))) tftpMetrics;
+
+// Yazma thread'ine verilen işin türü
+enum writeCommand {
+	WRITE_DATA = 1,		// Parçadaki verinin dosyaya yazılması
+	WRITE_FINISH,		// Dosyanın kalıcı hale getirilip (fsync) geçici adından asıl adına taşınması
+	WRITE_ABORT,		// Yarım kalan transferin geçici dosyasının silinmesi
+};
+
+// WRQ ile alınan dosyaların diske kalıcı yazılma modu (-d)
+enum writeDurability {
+	DURABILITY_NEVER = 1,	// fsync yapılmaz; veri çekirdeğin sayfa önbelleğine bırakılır
+	DURABILITY_END,			// Dosya, asıl adına taşınmadan önce fsync ile diske yazılır
+	DURABILITY_PERIODIC,	// Transfer boyunca her TFTP_SYNC_PERIOD_MB'da bir ve transfer sonunda fsync yapılır
+};
+
+// Yazma thread'ine verilen iş. WRQ'da gelen DATA blokları doğrudan paylaşılan havuzdan alınan parçaya (chunk) alınır; parça
+// dolduğunda yazma thread'ine verilir ve tek pwrite() ile dosyaya yazılır. Bitirme/iptal komutları da aynı kuyruktan geçer.
+typedef struct tftpWriteChunk {
+	struct tftpWriteChunk *next;		// Yazma kuyruğunda ya da boş parça listesinde sonraki eleman
+	struct tftpWriter *writer;			// İşin ait olduğu dosya
+	enum writeCommand command;			// İşin türü
+	uint8_t *data;						// TFTP_WRITE_CHUNK + TFTP_BLKSIZE_MAXIMUM baytlık sayfa hizalı tampon (komutlarda NULL)
+	size_t length;						// Parçadaki veri boyutu (bayt)
+	off_t offset;						// Parçanın dosyadaki konumu
+} tftpWriteChunk;
+
+// WRQ'da yazılan dosya. Veri, dosya adının sonuna ".XXXXXX" eklenmiş geçici dosyaya yazılır; transfer tamamlandığında geçici
+// dosya asıl adına taşınır (rename), böylece yarım kalan transferler hedef dosyayı bozmaz.
+typedef struct tftpWriter {
+	int fileDes;						// Geçici dosyanın betimleyicisi
+	char *fileName;						// Dosyanın asıl adı
+	char *tempName;						// Geçici dosyanın adı
+	off_t offset;						// Doldurulan parçanın (parça yoksa sıradaki bloğun) dosyadaki konumu
+	tftpWriteChunk *chunk;				// Gelen blokların alındığı, doldurulmakta olan parça
+	tftpWriteChunk command;				// Bitirme/iptal komutu için kullanılan iş (bitirmede offset, dosyanın son boyutudur)
+	int preallocated;					// Dosya için tsize kadar yer önceden ayrıldıysa (fallocate) 1
+	off_t unsyncedBytes;				// Son fdatasync() çağrısından sonra yazılan veri (yazma thread'i kullanır)
+	int error;							// Yazma thread'inde oluşan ilk hatanın errno değeri (writeMutex ile korunur)
+	struct tftpSession *session;		// Dosyayı yazan oturum; oturum sonlandırıldıysa NULL
+	struct tftpWriter *doneNext;		// Tamamlanan işler listesinde sonraki eleman
+	struct tftpWriter **doneList;		// Dosyayı açan worker'ın tamamlanan işler listesi
+	int eventFd;						// Dosyayı açan worker'ın uyandırıldığı eventfd
+} tftpWriter;
+
+// Olay döngüsü thread'lerinin (worker) başlangıç bilgileri
+typedef struct tftpWorker {
+	unsigned int index;					// Worker sırası (sayaç bloğu da bu sıradadır)
+	int socketFilDes;					// Worker'ın SO_REUSEPORT ile açılmış dinleme soketi
+	int cpu;							// Worker'ın sabitleneceği işlemci; -1 ise sabitlenmez
+	pthread_t thread;
+} tftpWorker;
+
+// Transfer oturumunun (session) durumları
+enum sessionState {
+	SESSION_RRQ_WAIT_ACK = 1,	// RRQ: DATA paketi gönderildi, karşılığındaki ACK bekleniyor
+	SESSION_WRQ_WAIT_DATA,		// WRQ: ACK paketi gönderildi, sıradaki DATA paketi bekleniyor
+	SESSION_WRQ_FLUSH,			// WRQ: son DATA alındı, dosya diske kaydedilene kadar son ACK bekletiliyor
+	SESSION_CLOSED,				// Oturum sonlandırıldı, olay döngüsü turunun sonunda bellekten silinecek
+};
+
+// Her RRQ/WRQ transferinin durumunu tutan oturum nesnesi. Olay döngüsü, soket okunabilir olduğunda veya zaman aşımı
+// süresi dolduğunda oturumu bir adım ilerletir; böylece transfer başına process ya da thread gerekmez.
+typedef struct tftpSession {
+	int socketFilDes;					// Transfere ait soketin dosya betimleyicisi
+	struct sockaddr_in client_socket;	// Client'ın adres bilgileri (Transfer ID)
+	socklen_t socketLength;				// Client adres struct'ının boyutu
+	char clientAddr[INET_ADDRSTRLEN];	// Client ip adresinin yazdırılabilir hali
+	enum sessionState state;			// Oturumun bulunduğu durum
+	uint16_t opcode;					// İsteğin işlem kodu (RRQ/WRQ)
+	FILE *fd;							// RRQ: okunan dosyanın akışı (dosya eşlenemediyse kullanılır)
+	tftpFileMap *fileMap;				// RRQ: okunan dosyanın paylaşılan bellek eşlemesi
+	tftpWriter *writer;					// WRQ: yazılan dosya
+	uint32_t blockNumber;				// Onaylanan son bloğun sıra numarası (paketlerdeki blok numarası bu değerin alt 16 bitidir)
+	unsigned int packetCount;			// Transfer boyunca aktarılan paket sayısı
+	uint64_t deadline;					// Son paket için zaman aşımının dolacağı an (monotonik, mikrosaniye)
+	int timerIndex;						// Oturumun zamanlayıcı yığınındaki (heap) konumu, yığında değilse -1
+	uint64_t sentTime;					// Son paketin (ya da pencerenin) gönderildiği an
+	uint64_t lastProgress;				// Transferin son ilerlediği (yeni ACK/DATA alındığı) an; transferden vazgeçme süresi buradan ölçülür
+	int retransmitted;					// Son ilerlemeden sonra yeniden gönderim yapıldıysa 1 (Karn kuralı: bu durumda RTT ölçülmez)
+	unsigned int retransmitCount;		// Transfer boyunca yapılan yeniden gönderim sayısı
+	uint32_t srtt;						// Yumuşatılmış gidiş-dönüş süresi (SRTT, mikrosaniye), ölçüm yapılmadıysa 0
+	uint32_t rttvar;					// Gidiş-dönüş süresinin sapması (RTTVAR, mikrosaniye)
+	uint32_t rto;						// Yeniden gönderim süresi (RTO, mikrosaniye)
+	uint8_t timeoutOption;				// Client'ın timeout seçeneğiyle istediği sabit zaman aşımı (saniye), istenmediyse 0
+	uint64_t transferSize;				// tsize seçeneği (RFC 2349): RRQ'da dosyanın boyutu, WRQ'da Client'ın bildirdiği boyut; yoksa 0
+	uint64_t transferredBytes;			// WRQ: alınan toplam veri
+	char *fileName;						// Transfer edilen dosyanın adı (transfer özeti için)
+	enum transferMode mode;				// Transfer modu
+	uint64_t startTime;					// Oturumun oluşturulduğu an (monotonik, mikrosaniye)
+	const char *result;					// Oturumun sonlanma nedeni (transfer özeti için); belirtilmediyse "failed"
+	int to_close;						// Son paket gönderildiğinde/alındığında 1 olur
+	uint16_t blockSize;					// Client ile anlaşılan blok boyutu (blksize seçeneği yoksa TFTP_DATA_DEFAULT)
+	uint16_t windowSize;				// Client ile anlaşılan pencere boyutu (windowsize seçeneği yoksa 1)
+	uint16_t windowCount;				// RRQ: penceredeki, dosyadan okunmuş ve onay bekleyen blok sayısı
+										// WRQ: son ACK'dan sonra sırasıyla alınan blok sayısı
+	int gapAcked;						// WRQ: sıra dışı blok için son alınan bloğun ACK'sı gönderildiyse 1 (tekrar ACK gönderilmez)
+	uint8_t *buffer;					// Paket tamponu. RRQ (eşlemesiz dosya): windowSize adet blockSize baytlık yuva; penceredeki blokların
+										// verisi yeniden gönderim için burada saklanır. WRQ: gelen DATA'nın başlığının (ve yazma havuzu
+										// doluysa verisinin) alındığı blockSize + 4 baytlık tampon
+	ssize_t dataLength;					// RRQ: dosyanın son bloğunun veri boyutu (to_close 1 olduğunda geçerlidir)
+	size_t oackLength;					// Gönderilen OACK henüz onaylanmadıysa OACK paketinin boyutu, aksi halde 0
+	uint8_t oack[TFTP_OACK_MAXIMUM];	// Client'a gönderilen OACK paketi (yeniden gönderim için saklanır)
+	struct tftpSession *prev;			// Oturum listesindeki önceki eleman
+	struct tftpSession *next;			// Oturum listesindeki sonraki eleman
+} tftpSession;
+
 char *fileBaseDirectory;
+tftpLogRecord logRing[TFTP_LOG_RING];		// Kayıtların, kayıt thread'i tarafından yazılana kadar tutulduğu halka
+atomic_size_t logTail;						// Kayıt üreten thread'lerin sıradaki yazacağı konum
+size_t logHead;								// Kayıt thread'inin sıradaki okuyacağı konum
+atomic_ulong logDropped;					// Halka dolu olduğu için atılan kayıt sayısı
+atomic_int logRunning;						// Kayıt thread'i çalışıyorsa 1 (çalışmıyorsa kayıtlar doğrudan stderr'e yazılır)
+enum logLevel logLevel = LOG_LEVEL_INFO;	// Üretilecek en ayrıntılı kayıt seviyesi (-l)
+pthread_t logThread;
+tftpMetrics metricsSlots[TFTP_METRICS_SLOTS];		// Thread başına sayaç blokları
+unsigned int metricsSlotCount = 1;					// Kullanılan sayaç bloğu sayısı
+_Thread_local tftpMetrics *threadMetrics = &metricsSlots[0];	// Çalışan thread'in sayaç bloğu
+char *metricsPath = NULL;							// Sayaç çıktısının sunulduğu Unix soketinin yolu (-M)
+int metricsFilDes = -1;								// Sayaç soketinin dosya betimleyicisi
+_Thread_local int epollFilDes = -1;						// Tüm soketlerin izlendiği epoll örneğinin dosya betimleyicisi
+_Thread_local tftpSession *sessionList = NULL;			// Aktif oturumların çift yönlü bağlı listesi
+_Thread_local tftpSession *closedSessionList = NULL;		// Olay döngüsü turunun sonunda serbest bırakılacak oturumlar
+_Thread_local unsigned int activeSessions = 0;			// Aktif oturum sayısı
+unsigned int maxSessions = TFTP_SESSION_DEFAULT;	// Aynı anda yürütülebilecek en fazla oturum sayısı
+unsigned int workerSessionLimit = TFTP_SESSION_DEFAULT;	// Bir worker'ın aynı anda yürütebileceği en fazla oturum sayısı
+unsigned int workerCount = 1;				// Olay döngüsü thread'i (worker) sayısı (-t)
+_Thread_local unsigned int workerIndex = 0;	// Çalışan worker'ın sırası
+unsigned int blockSizeLimit = TFTP_BLKSIZE_MAXIMUM;	// Client'ın blksize seçeneğiyle isteyebileceği blok boyutunun server tarafındaki sınırı
+unsigned int windowSizeLimit = TFTP_WINDOWSIZE_LIMIT;	// Client'ın windowsize seçeneğiyle isteyebileceği pencere boyutunun server tarafındaki sınırı
+atomic_int batchEnabled = 1;		// Çekirdek sendmmsg/recvmmsg desteklemiyorsa 0'a çekilir ve tekli paket fonksiyonlarına dönülür
+atomic_int gsoEnabled = 0;		// UDP GSO (UDP_SEGMENT) kullanımı; -g ile açılır, çekirdek desteklemiyorsa 0'a çekilir
+_Thread_local tftpSession **timerHeap = NULL;		// Tüm oturumların zaman aşımı anlarına göre sıralandığı ikili yığın (en yakını başta)
+_Thread_local unsigned int timerCount = 0;		// Yığındaki oturum sayısı
+_Thread_local unsigned int timerCapacity = 0;		// Yığın dizisinin kapasitesi
+pthread_mutex_t writeMutex = PTHREAD_MUTEX_INITIALIZER;	// Yazma kuyruğunu, boş parça listesini ve tamamlanan işleri korur
+pthread_cond_t writeCond = PTHREAD_COND_INITIALIZER;	// Yazma kuyruğuna iş eklendiğini yazma thread'ine bildirir
+pthread_once_t writeOnce = PTHREAD_ONCE_INIT;			// Tüm worker'ların paylaştığı yazma thread'i bir kez başlatılır
+int writeThreadError = 0;								// Yazma thread'i başlatılamadıysa pthread_create() hatası
+tftpWriteChunk *writeQueueHead = NULL;		// Yazma thread'inin sırayla işlediği iş kuyruğunun başı
+tftpWriteChunk *writeQueueTail = NULL;		// Yazma kuyruğunun sonu
+tftpWriteChunk *writeFreeList = NULL;		// Yazılmış, yeniden kullanılabilecek parçalar
+unsigned int writeChunkCount = 0;			// Havuz için ayrılmış toplam parça sayısı (writeMutex ile korunur)
+_Thread_local tftpWriter *writeDoneList = NULL;			// Yazma thread'inin bitirdiği, olay döngüsünde işlenecek dosyalar
+_Thread_local int writeEventFd = -1;						// Yazma thread'inin olay döngüsünü uyandırdığı eventfd
+enum writeDurability writeDurability = DURABILITY_END;	// WRQ dosyalarının diske kalıcı yazılma modu (-d)
+uint64_t uploadQuota = 0;					// WRQ ile yüklenebilecek en büyük dosya boyutu (bayt, -q); 0 ise sınırsız
+mode_t fileCreateMode = 0666;				// WRQ ile oluşturulan dosyaların izinleri (umask uygulanmış)
+_Thread_local tftpFileMap *fileMapTable[TFTP_FILEMAP_BUCKETS];	// Dosya eşlemelerinin aygıt/inode'a göre arama tablosu
+_Thread_local tftpFileMap *fileMapHead = NULL;					// LRU listesinin başı (en son kullanılan eşleme)
+_Thread_local tftpFileMap *fileMapTail = NULL;					// LRU listesinin sonu (en eski kullanılan eşleme)
+_Thread_local size_t fileMapBytes = 0;							// Önbellekteki eşlemelerin toplam boyutu (bayt)
+_Thread_local unsigned int fileMapCount = 0;						// Önbellekteki eşleme sayısı
+size_t fileMapLimit = (size_t) TFTP_FILEMAP_LIMIT_MB << 20;	// Önbelleğin toplam boyut sınırı (bayt)
+unsigned int fileMapEntryLimit = TFTP_FILEMAP_ENTRIES;	// Önbellekteki en fazla eşleme sayısı
+
+// Kayıt seviyelerinin çıktıdaki adları
+const char *tftp_log_level_name(enum logLevel level)
+{
+	switch (level) {
+	case LOG_LEVEL_ERROR:	return "error";
+	case LOG_LEVEL_WARNING:	return "warning";
+	case LOG_LEVEL_INFO:	return "info";
+	default:				return "debug";
+	}
+}
+
+// Kayıt üretilmesi. Kayıt, olay döngüsünü bekletmemek için halkaya yazılır ve kayıt thread'i tarafından toplu olarak çıktıya
+// aktarılır. Halkada yer ayırma kilitsizdir (birden çok üretici için compare-and-swap); halka doluysa kayıt atılır ve sayılır.
+void tftp_log(enum logLevel level, const char *format, ...)
+{
+	tftpLogRecord *record;
+	size_t position;
+	size_t sequence;
+	struct timespec ts;
+	va_list args;
+
+	if (level > logLevel) {
+		return;
+	}
+
+	if (!atomic_load_explicit(&logRunning, memory_order_acquire)) {	// Kayıt thread'i başlatılmadan önce kayıtlar doğrudan yazılır
+		va_start(args, format);
+		fprintf(stderr, "level=%s ", tftp_log_level_name(level));
+		vfprintf(stderr, format, args);
+		fputc('\n', stderr);
+		va_end(args);
+		return;
+	}
+
+	position = atomic_load_explicit(&logTail, memory_order_relaxed);
+
+	while (1) {	// Halkada yer ayrılması
+		record = &logRing[position % TFTP_LOG_RING];
+		sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+
+		if (sequence == position) {		// Kayıt boş: konum alınmaya çalışılır (başarısız olursa position güncellenir)
+			if (atomic_compare_exchange_weak_explicit(&logTail, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+				break;
+			}
+		} else if (sequence < position) {	// Halka dolu: kayıt thread'i henüz bu kaydı okumadı
+			atomic_fetch_add_explicit(&logDropped, 1, memory_order_relaxed);
+			return;
+		} else {							// Konum başka bir thread tarafından alındı
+			position = atomic_load_explicit(&logTail, memory_order_relaxed);
+		}
+	}
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	record->time = (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+	record->level = level;
+
+	va_start(args, format);
+	vsnprintf(record->text, sizeof(record->text), format, args);
+	va_end(args);
+
+	atomic_store_explicit(&record->sequence, position + 1, memory_order_release);	// Kaydın okunmaya hazır olduğunun bildirilmesi
+}
+
+// Sistem çağrısı hatasının kaydı (perror() karşılığı)
+void tftp_log_errno(const char *call)
+{
+	tftp_log(LOG_LEVEL_ERROR, "call=\"%s\" error=\"%s\"", call, strerror(errno));
+}
+
+// Kayıt thread'i. Halkadaki hazır kayıtları zaman damgası ve seviyeyle biçimlendirip tek write() çağrısıyla standart çıktıya
+// yazar; halka boşsa TFTP_LOG_FLUSH_MS bekler. logRunning 0'a çekildiğinde kalan kayıtları yazıp sonlanır.
+void *tftp_log_thread(void *arg)
+{
+	static char output[64 * 1024];	// Toplu yazılacak kayıtların biçimlendirildiği tampon
+	tftpLogRecord *record;
+	size_t used;
+	size_t written;
+	ssize_t c;
+	unsigned long dropped;
+	time_t second = 0;				// Tarih/saat metninin hesaplandığı son saniye
+	char timeString[24] = "";		// Son hesaplanan tarih/saat metni
+	struct tm tm;
+	struct timespec wait = { 0, TFTP_LOG_FLUSH_MS * 1000000L };
+	int running;
+
+	(void) arg;
+
+	do {
+		running = atomic_load_explicit(&logRunning, memory_order_acquire);
+		used = 0;
+
+		while (used + TFTP_LOG_LINE + 128 <= sizeof(output)) {
+			record = &logRing[logHead % TFTP_LOG_RING];
+			if (atomic_load_explicit(&record->sequence, memory_order_acquire) != logHead + 1) {	// Sıradaki kayıt henüz yazılmadı
+				break;
+			}
+
+			if ((time_t) (record->time / 1000000) != second) {	// Tarih/saat metni saniyede bir hesaplanır
+				second = record->time / 1000000;
+				gmtime_r(&second, &tm);
+				strftime(timeString, sizeof(timeString), "%Y-%m-%dT%H:%M:%S", &tm);
+			}
+
+			used += snprintf(output + used, sizeof(output) - used, "%s.%03uZ level=%s %s\n", timeString,
+					(unsigned int) (record->time % 1000000 / 1000), tftp_log_level_name(record->level), record->text);
+
+			atomic_store_explicit(&record->sequence, logHead + TFTP_LOG_RING, memory_order_release);	// Kaydın boşaltılması
+			logHead++;
+		}
+
+		if ((dropped = atomic_exchange_explicit(&logDropped, 0, memory_order_relaxed)) > 0) {
+			used += snprintf(output + used, sizeof(output) - used, "%s level=warning event=log_overflow dropped=%lu\n",
+					timeString, dropped);
+		}
+
+		for (written = 0; written < used; written += c) {
+			if ((c = write(STDOUT_FILENO, output + written, used - written)) < 0) {
+				if (errno == EINTR) {
+					c = 0;
+					continue;
+				}
+				break;
+			}
+		}
+
+		if (used == 0 && running) {
+			nanosleep(&wait, NULL);
+		}
+	} while (running || used > 0);
+
+	return NULL;
+}
+
+// Kayıt halkasının hazırlanması ve kayıt thread'inin başlatılması. Hata durumunda kayıtlar doğrudan stderr'e yazılmaya devam eder.
+void tftp_log_start(void)
+{
+	size_t i;
+
+	for (i = 0; i < TFTP_LOG_RING; i++) {
+		atomic_init(&logRing[i].sequence, i);
+	}
+
+	fflush(stdout);		// Başlangıç mesajlarının kayıtlardan önce yazılması
+	atomic_store_explicit(&logRunning, 1, memory_order_release);
+
+	if ((errno = pthread_create(&logThread, NULL, tftp_log_thread, NULL)) != 0) {
+		atomic_store_explicit(&logRunning, 0, memory_order_release);
+		tftp_log_errno("pthread_create()");
+	}
+}
+
+// Kayıt thread'inin, halkadaki kayıtlar yazıldıktan sonra sonlandırılması
+void tftp_log_stop(void)
+{
+	if (atomic_exchange_explicit(&logRunning, 0, memory_order_acq_rel)) {
+		pthread_join(logThread, NULL);
+	}
+}
+
+// Değerin 2'nin kuvveti sınırlı histogram kovasına eklenmesi (kova i, 2^(i-1) <= değer < 2^i aralığını sayar)
+void tftp_metrics_observe(atomic_uint_least64_t *buckets, uint64_t value)
+{
+	unsigned int index = value == 0 ? 0 : 64 - __builtin_clzll(value);
+
+	if (index >= TFTP_HISTOGRAM_BUCKETS) {
+		index = TFTP_HISTOGRAM_BUCKETS - 1;
+	}
+
+	atomic_store_explicit(&buckets[index], atomic_load_explicit(&buckets[index], memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+// Tüm sayaç bloklarında aynı konumdaki sayacın toplamı. field, sayacın tftpMetrics içindeki konumudur (offsetof).
+uint64_t tftp_metrics_sum(size_t field)
+{
+	uint64_t sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < metricsSlotCount; i++) {
+		sum += atomic_load_explicit((atomic_uint_least64_t *) ((char *) &metricsSlots[i] + field), memory_order_relaxed);
+	}
+
+	return sum;
+}
+
+// Histogramın Prometheus metin biçiminde (birikimli kovalar) yazılması. scale, kova sınırlarının saniyeye çevrilmesi için çarpandır.
+size_t tftp_metrics_histogram(char *output, size_t size, const char *name, const char *help, size_t buckets, size_t sum, double scale)
+{
+	size_t used;
+	uint64_t count = 0;
+	unsigned int i;
+
+	used = snprintf(output, size, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+
+	for (i = 0; i < TFTP_HISTOGRAM_BUCKETS - 1; i++) {
+		count += tftp_metrics_sum(buckets + i * sizeof(atomic_uint_least64_t));
+		used += snprintf(output + used, size - used, "%s_bucket{le=\"%g\"} %" PRIu64 "\n", name, (double) (1ULL << i) * scale, count);
+	}
+	count += tftp_metrics_sum(buckets + i * sizeof(atomic_uint_least64_t));
+
+	used += snprintf(output + used, size - used, "%s_bucket{le=\"+Inf\"} %" PRIu64 "\n%s_sum %g\n%s_count %" PRIu64 "\n",
+			name, count, name, tftp_metrics_sum(sum) / 1e6, name, count);
+
+	return used;
+}
+
+// Sayaç soketine bağlanan istemciye sayaçların Prometheus metin biçiminde yazılıp bağlantının kapatılması
+void tftp_metrics_serve(void)
+{
+	static char output[TFTP_METRICS_OUTPUT];
+	static const char *opName[2] = { "rrq", "wrq" };
+	static const char *codeName[TFTP_ERROR_CODES + 1] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "other" };
+	size_t used = 0;
+	int clientFilDes;
+	unsigned int i;
+
+	while ((clientFilDes = accept4(metricsFilDes, NULL, NULL, SOCK_CLOEXEC)) >= 0) {
+		if (used == 0) {	// Aynı turda bağlanan istemcilere aynı çıktı verilir
+#define	METRIC(name, type, help, field)	used += snprintf(output + used, sizeof(output) - used, \
+		"# HELP " name " " help "\n# TYPE " name " " type "\n" name " %" PRIu64 "\n", tftp_metrics_sum(offsetof(tftpMetrics, field)))
+			METRIC("tftp_sessions_active", "gauge", "Transfer sessions in progress.", sessionsActive);
+			METRIC("tftp_requests_rejected_total", "counter", "Requests rejected before a session was created.", requestsRejected);
+			METRIC("tftp_data_bytes_sent_total", "counter", "DATA payload bytes sent, including retransmissions.", bytesSent);
+			METRIC("tftp_data_bytes_received_total", "counter", "DATA payload bytes received.", bytesReceived);
+			METRIC("tftp_data_packets_sent_total", "counter", "DATA packets sent, including retransmissions.", packetsSent);
+			METRIC("tftp_data_packets_received_total", "counter", "DATA packets received.", packetsReceived);
+			METRIC("tftp_retransmits_total", "counter", "Packets or windows sent again after a timeout or loss report.", retransmits);
+			METRIC("tftp_timeouts_total", "counter", "Transfers abandoned after repeated timeouts.", timeouts);
+#undef	METRIC
+
+			used += snprintf(output + used, sizeof(output) - used, "# HELP tftp_transfers_total Finished transfers by operation and result.\n"
+					"# TYPE tftp_transfers_total counter\n");
+			for (i = 0; i < 2; i++) {
+				used += snprintf(output + used, sizeof(output) - used,
+						"tftp_transfers_total{op=\"%s\",result=\"ok\"} %" PRIu64 "\ntftp_transfers_total{op=\"%s\",result=\"failed\"} %" PRIu64 "\n",
+						opName[i], tftp_metrics_sum(offsetof(tftpMetrics, transfersCompleted) + i * sizeof(atomic_uint_least64_t)),
+						opName[i], tftp_metrics_sum(offsetof(tftpMetrics, transfersFailed) + i * sizeof(atomic_uint_least64_t)));
+			}
+
+			used += snprintf(output + used, sizeof(output) - used, "# HELP tftp_transfers_started_total Transfers started by operation.\n"
+					"# TYPE tftp_transfers_started_total counter\n");
+			for (i = 0; i < 2; i++) {
+				used += snprintf(output + used, sizeof(output) - used, "tftp_transfers_started_total{op=\"%s\"} %" PRIu64 "\n",
+						opName[i], tftp_metrics_sum(offsetof(tftpMetrics, transfersStarted) + i * sizeof(atomic_uint_least64_t)));
+			}
+
+			used += snprintf(output + used, sizeof(output) - used, "# HELP tftp_errors_sent_total ERROR packets sent by error code.\n"
+					"# TYPE tftp_errors_sent_total counter\n");
+			for (i = 0; i <= TFTP_ERROR_CODES; i++) {
+				used += snprintf(output + used, sizeof(output) - used, "tftp_errors_sent_total{code=\"%s\"} %" PRIu64 "\n",
+						codeName[i], tftp_metrics_sum(offsetof(tftpMetrics, errorsSent) + i * sizeof(atomic_uint_least64_t)));
+			}
+
+			used += tftp_metrics_histogram(output + used, sizeof(output) - used, "tftp_transfer_duration_seconds",
+					"Duration of finished transfers.", offsetof(tftpMetrics, durationBuckets), offsetof(tftpMetrics, durationSum), 1e-3);
+			used += tftp_metrics_histogram(output + used, sizeof(output) - used, "tftp_rtt_seconds",
+					"Round-trip time samples used for retransmission timers.", offsetof(tftpMetrics, rttBuckets), offsetof(tftpMetrics, rttSum), 1e-6);
+		}
+
+		if (write(clientFilDes, output, used) < 0) {	// Çıktı soket tamponuna sığar; yazılamazsa istemci yeniden bağlanabilir
+			tftp_log_errno("write()");
+		}
+		close(clientFilDes);
+	}
+}
+
+// Sayaç soketinin oluşturulup olay döngüsüne kaydedilmesi. Soket, kendi adresiyle (&metricsFilDes) ayırt edilir.
+// Hata durumunda -1 döndürür.
+int tftp_metrics_start(void)
+{
+	struct sockaddr_un address;
+	struct epoll_event event;
+
+	if (strlen(metricsPath) >= sizeof(address.sun_path)) {
+		tftp_log(LOG_LEVEL_ERROR, "event=metrics_disabled path=\"%s\" error=\"path too long\"", metricsPath);
+		return -1;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, metricsPath);
+	unlink(metricsPath);	// Önceki çalışmadan kalan soket dosyasının silinmesi
+
+	if ((metricsFilDes = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0) {
+		tftp_log_errno("socket()");
+		return -1;
+	}
+
+	if (bind(metricsFilDes, (struct sockaddr *) &address, sizeof(address)) < 0 || listen(metricsFilDes, 16) < 0) {
+		tftp_log_errno("bind()");
+		close(metricsFilDes);
+		return -1;
+	}
+
+	event.events = EPOLLIN;
+	event.data.ptr = &metricsFilDes;
+
+	if (epoll_ctl(epollFilDes, EPOLL_CTL_ADD, metricsFilDes, &event) < 0) {
+		tftp_log_errno("epoll_ctl()");
+		close(metricsFilDes);
+		return -1;
+	}
+
+	return 0;
+}
 
 // Soket Kurulumu
-int16_t tftp_socket_start(void)
+int tftp_socket_start(void)
 {
-	int16_t socketFilDes = -1; 	// Socket kimliği, socket() fonksiyonunun hata belirttiği değerle tanımlandı
+	int socketFilDes = -1; 	// Socket kimliği, socket() fonksiyonunun hata belirttiği değerle tanımlandı
 
 	struct protoent *protocole;	// Protokol veritabanı bilgilerinin yer alacağı struct'ın oluşturulması
-
-	struct timeval tv;				// Zaman değişkenlerinin tutulabileceği struct'ın oluşturulması
-	tv.tv_sec  = RECEIVE_TIMEOUT_SEC;	// Zaman aşımı için saniye cinsinden sürenin tanımlanması
-	tv.tv_usec = RECEIVE_TIMEOUT_USEC;	// Zaman aşımı için mikrosaniye cinsinden sürenin tanımlanması
+	struct protoent protoentBuffer;	// getprotobyname_r() için thread'e özel protokol kaydı
+	char protoentData[1024];		// getprotobyname_r() için thread'e özel yardımcı tampon
 
 	// Protokol Seçimi (UDP)
-	if ((protocole = getprotobyname("udp")) == 0) {		  	              // Hata Kontrolü: Protokol seçimi hatalı yapıldığında
-		fprintf(stderr, "Server: tftp_socket_start(): getprotobyname() error\n"); // getprotobyname() fonksiyonu 0 değerini döndürür
-		exit(EXIT_FAILURE);
+	// getprotobyname() statik tampon kullandığından işçi thread'lerinde yeniden girişli (reentrant) sürümü çağrılır
+	if (getprotobyname_r("udp", &protoentBuffer, protoentData, sizeof(protoentData), &protocole) != 0 || protocole == NULL) { // Hata Kontrolü
+		tftp_log(LOG_LEVEL_ERROR, "call=\"getprotobyname()\" error=\"udp protocol not found\"");	// getprotobyname() fonksiyonu 0 değerini döndürür
+		return -1;
 	}
 
 	// Server-Client İletişimi İçin Soket Kurulumu
 	// AF_INET: İletişim etki alanının IPv4 olacağını belirtir. Local istenseydi AF_UNIX olurdu.
 	// SOCK_DGRAM: İletişimin anlamsallığının(semantic), bağlantısız çalışıp datagramları desteklediğini belirtir
+	// SOCK_NONBLOCK: Soket olay döngüsünde kullanıldığından okuma işlemleri bloklamaz, veri yoksa EAGAIN döner
 	// protocole->p_proto: Protokol türünü belirtir. 0 yazılabilir.
-	if ((socketFilDes = socket(AF_INET, SOCK_DGRAM, protocole->p_proto)) == -1) { // Hata Kontrolü: socket() fonksiyonu hata durumunda
-		perror("Server: tftp_socket_start(): socket()"); 								  // -1 değeri döndürür
-		exit(EXIT_FAILURE);
+	if ((socketFilDes = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, protocole->p_proto)) == -1) { // Hata Kontrolü: socket() fonksiyonu hata durumunda
+		tftp_log_errno("socket()"); 								  // -1 değeri döndürür
+		return -1;
 	}
 
-	// Soket İçin Zaman Aşımı Ayarının Yapılması
-	// SOL_SOCKET: Level argümanı olup soket seviyesinde işlem yapıldığını belirtir
-	// SO_RCVTIMEO seçeneği, bir giriş işleminin tamamlanasaya kadar beklenecek maksimum süreyi belirten zaman aşımı değeridir
-	if(setsockopt(socketFilDes, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) { // Hata Kontrolü: setsockopt() fonksiyonu başarılı
-		perror("Server: tftp_socket_start(): setsockopt()");							 // çalıştığında 0; hata durumunda -1 döndürür.
-		close(socketFilDes);	// Soketin sonlandırılması
-		exit(EXIT_FAILURE);
-	}
+	// Zaman aşımı artık soket seçeneğiyle (SO_RCVTIMEO) değil, oturumun RTT ölçümünden hesaplanan deadline alanı ve
+	// tüm oturumların paylaştığı zamanlayıcı yığını üzerinden olay döngüsünde takip edilir
 
 	return socketFilDes;
 }
 
-// Client'tan paket almayı sağlayan fonksiyon. Gönderdiği verinin boyutunu döndürür.
-signed int tftp_receive_message(signed short socketID, tftpMessage *message, struct sockaddr_in *socket, socklen_t *socketLength)
+// Client'tan paket almayı sağlayan fonksiyon. Paket, messageSize baytlık message tamponuna yazılır. Gönderdiği verinin boyutunu döndürür.
+signed int tftp_receive_message(int socketID, void *message, size_t messageSize, struct sockaddr_in *socket, socklen_t *socketLength)
 {
 	signed int receivedMessageSize;		// Gelen verinin, bayt cinsinden boyutunun kaydedileceği değişken
 
-	if (((receivedMessageSize = recvfrom(socketID, message, sizeof(*message), 0, (struct sockaddr *) socket, socketLength)) < 0) && (errno != EAGAIN)) {
-		perror("SERVER ERROR: recvfrom()!"); //Alınan son hatanın açıklamasını yazdırır (Hata, errno değişkeninde saklanır)
+	if (((receivedMessageSize = recvfrom(socketID, message, messageSize, 0, (struct sockaddr *) socket, socketLength)) < 0) && (errno != EAGAIN)) {
+		tftp_log_errno("recvfrom()"); //Alınan son hatanın açıklamasını yazdırır (Hata, errno değişkeninde saklanır)
+	}
+
+	return receivedMessageSize;		// Gelen verinin, bayt cinsinden boyutunun geri döndürülmesi
+}
+
+// Client'tan DATA paketi almayı sağlayan fonksiyon. Paketin 4 baytlık başlığı header tamponuna, verisi en fazla dataSize bayt
+// olarak data tamponuna yazılır (scatter/gather); böylece veri, kopyalanmadan doğrudan yazma parçasına alınabilir.
+// Gelen paketin toplam boyutunu döndürür.
+signed int tftp_receive_data(int socketID, uint8_t *header, uint8_t *data, size_t dataSize, struct sockaddr_in *socket, socklen_t *socketLength)
+{
+	struct iovec iov[2];	// Paketin parçaları: başlık ve veri
+	struct msghdr msg;
+	signed int receivedMessageSize;
+
+	iov[0].iov_base = header;
+	iov[0].iov_len = TFTP_DATA_MINIMUM;
+	iov[1].iov_base = data;
+	iov[1].iov_len = dataSize;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = socket;
+	msg.msg_namelen = *socketLength;
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	if ((receivedMessageSize = recvmsg(socketID, &msg, 0)) < 0) {
+		if (errno != EAGAIN) {
+			tftp_log_errno("recvmsg()");
+		}
+		return receivedMessageSize;
+	}
+
+	*socketLength = msg.msg_namelen;
+
+	return receivedMessageSize;
+}
+
+// Client'a DATA paketinin gönderimini sağlayan olan fonksiyon.  Gönderdiği verinin boyutunu döndürür.
+// Paket, 4 baytlık başlık ve verinin kendisinden oluşan iki parçadan (scatter/gather) birleştirilerek gönderilir; veri kopyalanmaz.
+signed int tftp_send_data(int socketID, uint16_t blockNumber, const uint8_t *data, ssize_t dataLength, struct sockaddr_in *socket, socklen_t socketLength)
+{
+	uint16_t header[2];		// DATA paketinin başlığı (opcode ve blok numarası)
+	struct iovec iov[2];	// Paketin parçaları: başlık ve veri
+	struct msghdr msg;		// sendmsg() için paket tanımı
+	signed int sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun kaydedileceği değişken
+
+	header[0] = htons(DATA); 			// Opcode verisinin, bellekte, ağ bayt sıralamasına göre DATA olarak tutulmasını sağlar
+	header[1] = htons(blockNumber); 	// Blok numarası verisinin, bellekte ağ bayt sıralamasına göre (MSB) tutulmasını sağlar
+
+	iov[0].iov_base = header;
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = (void *) data;
+	iov[1].iov_len = dataLength;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = socket;
+	msg.msg_namelen = socketLength;
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	if ((sentSize = sendmsg(socketID, &msg, 0)) < 0) { // Paket gönderimi
+		tftp_log_errno("sendto()");	// Paket gönderiminin hata kontrolü. Alınan hatanın açıklamasını yazdırır. (Hata, errno değişkeninde saklanır)
+	}
+
+	return sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun geri döndürülmesi
+}
+
+// Art arda blok numaralı DATA paketlerinin toplu gönderimi. firstBlock: ilk paketin blok numarası, data/dataLength: paketlerin
+// verileri ve boyutları. Eşit boyutlu paketler GSO açıksa tek sendmsg() ile (çekirdek paketlere böler), değilse tek sendmmsg() ile
+// gönderilir; destek yoksa tftp_send_data()'ya dönülür. Gönderilen paket sayısını, hata durumunda -1 döndürür. Soket tamponu
+// dolduğunda (EAGAIN/ENOBUFS) kalan paketler gönderilmez; bunlar zaman aşımında yeniden gönderilir.
+signed int tftp_send_data_batch(int socketID, uint32_t firstBlock, const uint8_t **data, const size_t *dataLength, unsigned int count,
+		struct sockaddr_in *socket, socklen_t socketLength)
+{
+	uint16_t header[TFTP_SEND_BATCH][2];		// Paketlerin başlıkları (opcode ve blok numarası)
+	struct iovec iov[TFTP_SEND_BATCH * 2];		// Paketlerin parçaları: her paket için başlık ve veri
+	struct mmsghdr msgs[TFTP_SEND_BATCH];		// sendmmsg() için paket tanımları
+	char control[CMSG_SPACE(sizeof(uint16_t))];	// GSO segment boyutunun iletildiği yardımcı veri
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	unsigned int sent = 0;		// Gönderilen paket sayısı
+	unsigned int segments;		// GSO ile tek seferde gönderilecek paket sayısı
+	uint16_t segmentSize;		// GSO segment boyutu (başlık dahil paket boyutu)
+	int c;
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		header[i][0] = htons(DATA);
+		header[i][1] = htons((uint16_t) (firstBlock + i));
+		iov[2 * i].iov_base = header[i];
+		iov[2 * i].iov_len = sizeof(header[i]);
+		iov[2 * i + 1].iov_base = (void *) data[i];
+		iov[2 * i + 1].iov_len = dataLength[i];
+	}
+
+	// UDP GSO: yalnızca son paketi kısa olabilen, eşit boyutlu paket dizileri tek bir büyük datagram olarak verilir
+	while (gsoEnabled && count - sent > 1) {
+		segmentSize = dataLength[sent] + TFTP_DATA_MINIMUM;
+		segments = TFTP_GSO_MAXIMUM / segmentSize;
+		if (segments > count - sent) {
+			segments = count - sent;
+		}
+		for (i = 1; i < segments - 1 && dataLength[sent + i] == dataLength[sent]; i++);
+		if (i < segments - 1) {		// Eşit boyutlu olmayan paketler GSO ile gönderilemez
+			break;
+		}
+		if (segments < 2) {
+			break;
+		}
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_name = socket;
+		msg.msg_namelen = socketLength;
+		msg.msg_iov = &iov[2 * sent];
+		msg.msg_iovlen = 2 * segments;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_UDP;
+		cmsg->cmsg_type = UDP_SEGMENT;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+		memcpy(CMSG_DATA(cmsg), &segmentSize, sizeof(segmentSize));
+
+		if (sendmsg(socketID, &msg, 0) < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {	// Soket tamponu dolu
+				return sent;
+			}
+			if (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT || errno == EOPNOTSUPP) {	// Çekirdek ya da arabirim GSO desteklemiyor
+				tftp_log(LOG_LEVEL_WARNING, "event=gso_disabled reason=\"not supported\"");
+				gsoEnabled = 0;
+				break;
+			}
+			tftp_log_errno("sendmsg()");
+			return -1;
+		}
+		sent += segments;
+	}
+
+	while (batchEnabled && sent < count) {	// Kalan paketlerin tek sendmmsg() çağrısıyla gönderimi
+		for (i = sent; i < count; i++) {
+			memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_name = socket;
+			msgs[i].msg_hdr.msg_namelen = socketLength;
+			msgs[i].msg_hdr.msg_iov = &iov[2 * i];
+			msgs[i].msg_hdr.msg_iovlen = 2;
+		}
+
+		if ((c = sendmmsg(socketID, &msgs[sent], count - sent, 0)) < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {	// Soket tamponu dolu
+				return sent;
+			}
+			if (errno == ENOSYS) {	// Çekirdek sendmmsg() desteklemiyor
+				batchEnabled = 0;
+				break;
+			}
+			tftp_log_errno("sendmmsg()");
+			return -1;
+		}
+		sent += c;
+	}
+
+	for (; sent < count; sent++) {	// Toplu gönderim desteklenmiyorsa paketler tek tek gönderilir
+		if (tftp_send_data(socketID, (uint16_t) (firstBlock + sent), data[sent], dataLength[sent], socket, socketLength) < 0) {
+			return (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) ? (signed int) sent : -1;
+		}
+	}
+
+	return sent;
+}
+
+// Client'a ACK paketinin gönderimini sağlayan fonksiyon. Gönderdiği verinin boyutunu döndürür.
+signed short tftp_send_ack(int socketID, uint16_t blockNumber, struct sockaddr_in *socket, socklen_t socketLength)
+{
+	tftpMessage message;	// tftpMessage bileşimindeki veri türlerinin, fonksiyon içerisinde kullanıma hazır hale getirilmesi
+	signed short sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun kaydedileceği değişken
+
+	message.opcode = htons(ACK); 					// Opcode verisinin, bellekte, ağ bayt sıralamasına göre ACK olarak tutulmasını sağlar
+	message.ack.blockNumber = htons(blockNumber);	// Blok numarası verisinin, bellekte ağ bayt sıralamasına göre (MSB) tutulmasını sağlar
+
+	if ((sentSize = sendto(socketID, &message, sizeof(message.ack), 0, (struct sockaddr *) socket, socketLength)) < 0) { // Paket gönderimi
+		tftp_log_errno("sendto()"); // Paket gönderiminin hata kontrolü. Alınan hatanın açıklamasını yazdırır. (Hata, errno değişkeninde saklanır)
+	}
+
+	return sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun geri döndürülmesi
+}
+
+// Client'a OACK paketinin gönderimini sağlayan fonksiyon. oack, tftp_options_negotiate() ile hazırlanmış paketin tamamıdır.
+// Gönderdiği verinin boyutunu döndürür.
+signed int tftp_send_oack(int socketID, uint8_t *oack, size_t oackLength, struct sockaddr_in *socket, socklen_t socketLength)
+{
+	signed int sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun kaydedileceği değişken
+
+	if ((sentSize = sendto(socketID, oack, oackLength, 0, (struct sockaddr *) socket, socketLength)) < 0) { // Paket gönderimi
+		tftp_log_errno("sendto()"); // Paket gönderiminin hata kontrolü. Alınan hatanın açıklamasını yazdırır. (Hata, errno değişkeninde saklanır)
+	}
+
+	return sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun geri döndürülmesi
+}
+
+// Client'a ERROR paketinin gönderimini sağlayan fonksiyon. Gönderdiği verinin boyutunu döndürür.
+signed short tftp_server_send_error(int socketID, int errorCode, char *errorString, struct sockaddr_in *socket, socklen_t socketLength)
+{
+	tftpMessage message;	// tftpMessage bileşimindeki veri türlerinin, fonksiyon içerisinde kullanıma hazır hale getirilmesi
+	signed short sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun kaydedileceği değişken
+
+	if(strlen(errorString) >= TFTP_DATA_DEFAULT) { // Hata mesajı boyutunun sınırının aşılma durumunun kontrolü
+		tftp_log(LOG_LEVEL_ERROR, "event=send_error error=\"error message too long\"");
+		return -1;
+	}
+
+	TFTP_METRIC_ADD(errorsSent[errorCode >= 0 && errorCode < TFTP_ERROR_CODES ? errorCode : TFTP_ERROR_CODES], 1);
+
+	message.opcode = htons(ERROR);				// Opcode verisinin bellekte ağ bayt sıralamasına göre ERROR olarak tutulmasını sağlar
+	message.error.errorCode = htons(errorCode);		// Hata kodu numarasının, bellekte tutulan değişkene ağ bayt sıralamasına göre kaydı
+	strcpy(message.error.errorMessage, errorString);	// Hata mesajının, bellekteki errorMessage değişkenine kopyalanması
+
+	if ((sentSize = sendto(socketID, &message, strlen(errorString) + 1, 0, (struct sockaddr *) socket, socketLength)) < 0)	// Paket gönderimi
+	{																								// ve hata kontrolü
+		tftp_log_errno("sendto()");	// Paket gönderiminin hata kontrolü. Alınan hatanın açıklamasını yazdırır. (Hata, errno değişkeninde saklanır)
+	}
+
+	return sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun geri döndürülmesi
+}
+
+// Eşlemenin LRU listesinden çıkarılması
+void tftp_filemap_unlink(tftpFileMap *map)
+{
+	if (map->prev != NULL) {
+		map->prev->next = map->next;
+	} else {
+		fileMapHead = map->next;
+	}
+	if (map->next != NULL) {
+		map->next->prev = map->prev;
+	} else {
+		fileMapTail = map->prev;
+	}
+	map->prev = map->next = NULL;
+}
+
+// Eşlemenin önbellekten (arama tablosu ve LRU listesi) çıkarılması. Eşleme kullanımda değilse bellekten de silinir.
+void tftp_filemap_remove(tftpFileMap *map)
+{
+	tftpFileMap **slot = &fileMapTable[(map->device ^ map->inode) % TFTP_FILEMAP_BUCKETS];
+
+	while (*slot != map) {
+		slot = &(*slot)->hashNext;
+	}
+	*slot = map->hashNext;
+
+	tftp_filemap_unlink(map);
+	fileMapBytes -= map->size;
+	fileMapCount--;
+	map->stale = 1;
+
+	if (map->refCount == 0) {
+		munmap(map->data, map->size);
+		free(map);
+	}
+}
+
+// Önbellek sınırları aşıldıysa kullanılmayan eşlemelerin en eskisinden başlanarak silinmesi
+void tftp_filemap_evict(void)
+{
+	tftpFileMap *map = fileMapTail;
+	tftpFileMap *prev;
+
+	while (map != NULL && (fileMapBytes > fileMapLimit || fileMapCount > fileMapEntryLimit)) {
+		prev = map->prev;
+		if (map->refCount == 0) {	// Kullanımdaki eşlemeler silinmez
+			tftp_filemap_remove(map);
+		}
+		map = prev;
+	}
+}
+
+// Açık dosyanın paylaşılan eşlemesinin alınması. Dosya önbellekte ve değişmemişse mevcut eşleme kullanılır, aksi halde dosya
+// eşlenip önbelleğe eklenir. Dosya eşlenemiyorsa (boş ya da normal olmayan dosya, mmap hatası) NULL döndürür.
+tftpFileMap *tftp_filemap_acquire(int fileDes)
+{
+	struct stat fileStat;	// Dosyanın aygıt, inode, boyut ve değişiklik zamanı bilgileri
+	tftpFileMap *map;
+	void *data;
+	unsigned int bucket;
+
+	if (fstat(fileDes, &fileStat) < 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size == 0) {
+		return NULL;
+	}
+
+	bucket = (fileStat.st_dev ^ fileStat.st_ino) % TFTP_FILEMAP_BUCKETS;
+
+	for (map = fileMapTable[bucket]; map != NULL; map = map->hashNext) {
+		if (map->device == fileStat.st_dev && map->inode == fileStat.st_ino) {
+			if (map->size == (size_t) fileStat.st_size && map->modifyTime.tv_sec == fileStat.st_mtim.tv_sec &&
+					map->modifyTime.tv_nsec == fileStat.st_mtim.tv_nsec) {	// Dosya değişmediyse eşleme paylaşılır
+				map->refCount++;
+				tftp_filemap_unlink(map);	// Eşlemenin LRU listesinin başına taşınması
+				map->next = fileMapHead;
+				if (fileMapHead != NULL) {
+					fileMapHead->prev = map;
+				} else {
+					fileMapTail = map;
+				}
+				fileMapHead = map;
+				return map;
+			}
+			tftp_filemap_remove(map);	// Dosya değiştiyse eski eşleme önbellekten çıkarılır (kullanan oturumlar eski içeriği görmeye devam eder)
+			break;
+		}
+	}
+
+	if ((data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fileDes, 0)) == MAP_FAILED) {
+		tftp_log_errno("mmap()");
+		return NULL;
+	}
+
+	if ((map = calloc(1, sizeof(tftpFileMap))) == NULL) {
+		munmap(data, fileStat.st_size);
+		return NULL;
+	}
+
+	map->device = fileStat.st_dev;
+	map->inode = fileStat.st_ino;
+	map->modifyTime = fileStat.st_mtim;
+	map->data = data;
+	map->size = fileStat.st_size;
+	map->refCount = 1;
+
+	map->hashNext = fileMapTable[bucket];	// Arama tablosuna ve LRU listesinin başına eklenmesi
+	fileMapTable[bucket] = map;
+	map->next = fileMapHead;
+	if (fileMapHead != NULL) {
+		fileMapHead->prev = map;
+	} else {
+		fileMapTail = map;
+	}
+	fileMapHead = map;
+	fileMapBytes += map->size;
+	fileMapCount++;
+
+	tftp_filemap_evict();
+
+	return map;
+}
+
+// Oturumun eşlemeyi bırakması. Dosya değiştiyse ve eşlemeyi kullanan başka oturum kalmadıysa eşleme silinir.
+void tftp_filemap_release(tftpFileMap *map)
+{
+	if (--map->refCount > 0) {
+		return;
+	}
+
+	if (map->stale) {
+		munmap(map->data, map->size);
+		free(map);
+	} else {
+		tftp_filemap_evict();
+	}
+}
+
+// Verinin tamamının dosyanın offset konumuna yazılması. Hata durumunda errno ayarlanmış olarak -1 döndürür.
+int tftp_write_full(int fileDes, const uint8_t *data, size_t length, off_t offset)
+{
+	ssize_t written;
+
+	while (length > 0) {
+		if ((written = pwrite(fileDes, data, length, offset)) <= 0) {
+			if (written < 0 && errno == EINTR) {
+				continue;
+			}
+			if (written == 0) {
+				errno = ENOSPC;
+			}
+			return -1;
+		}
+		data += written;
+		length -= written;
+		offset += written;
+	}
+
+	return 0;
+}
+
+// Yazma thread'i. Kuyruktaki parçaları sırayla dosyalarına yazar, bitirme/iptal komutlarını işler ve tamamlanan dosyaları
+// eventfd üzerinden olay döngüsüne bildirir. Disk gecikmesi böylece ağ tarafında ACK gönderimini bekletmez.
+void *tftp_writer_thread(void *arg)
+{
+	tftpWriteChunk *job;
+	tftpWriter *writer;
+	int error;
+	char *directory;	// Taşınan dosyanın bulunduğu dizin (dizin girdisinin kalıcı hale getirilmesi için)
+	char *slash;
+	int directoryDes;
+	uint64_t one = 1;
+
+	(void) arg;
+
+	while (1) {
+		pthread_mutex_lock(&writeMutex);
+		while (writeQueueHead == NULL) {
+			pthread_cond_wait(&writeCond, &writeMutex);
+		}
+		job = writeQueueHead;
+		if ((writeQueueHead = job->next) == NULL) {
+			writeQueueTail = NULL;
+		}
+		writer = job->writer;
+		error = writer->error;
+		pthread_mutex_unlock(&writeMutex);
+
+		if (job->command == WRITE_DATA) {	// Hata oluşmuş dosyaya yazılmaya devam edilmez, parça yalnızca havuza döner
+			if (error == 0 && tftp_write_full(writer->fileDes, job->data, job->length, job->offset) < 0) {
+				error = errno;
+			}
+			if (error == 0 && writeDurability == DURABILITY_PERIODIC &&
+					(writer->unsyncedBytes += job->length) >= (off_t) TFTP_SYNC_PERIOD_MB << 20) {
+				if (fdatasync(writer->fileDes) < 0) {
+					error = errno;
+				}
+				writer->unsyncedBytes = 0;
+			}
+
+			pthread_mutex_lock(&writeMutex);
+			writer->error = error;
+			job->next = writeFreeList;
+			writeFreeList = job;
+			pthread_mutex_unlock(&writeMutex);
+			continue;
+		}
+
+		if (job->command == WRITE_FINISH && error == 0 && writer->preallocated && ftruncate(writer->fileDes, job->offset) < 0) {
+			error = errno;	// Bildirilenden kısa dosyada, önceden ayrılıp kullanılmayan alanın bırakılması
+		}
+		if (job->command == WRITE_FINISH && error == 0 && writeDurability != DURABILITY_NEVER && fsync(writer->fileDes) < 0) {
+			error = errno;
+		}
+		if (close(writer->fileDes) < 0 && error == 0) {
+			error = errno;
+		}
+		if (job->command == WRITE_FINISH && error == 0) {
+			if (rename(writer->tempName, writer->fileName) < 0) {	// Geçici dosyanın asıl adına taşınması (atomik)
+				error = errno;
+			} else if (writeDurability != DURABILITY_NEVER) {		// Taşımanın da kalıcı olması için dizinin fsync'i
+				slash = strrchr(writer->fileName, '/');
+				directory = slash != NULL ? strndup(writer->fileName, slash - writer->fileName + 1) : NULL;
+				if ((directoryDes = open(directory != NULL ? directory : ".", O_RDONLY | O_DIRECTORY)) >= 0) {
+					fsync(directoryDes);
+					close(directoryDes);
+				}
+				free(directory);
+			}
+		}
+		if (job->command == WRITE_ABORT || error != 0) {
+			unlink(writer->tempName);	// Yarım kalan ya da kaydedilemeyen geçici dosyanın silinmesi
+		}
+
+		pthread_mutex_lock(&writeMutex);
+		writer->error = error;
+		writer->doneNext = *writer->doneList;	// Dosyayı açan worker'ın listesine eklenir
+		*writer->doneList = writer;
+		pthread_mutex_unlock(&writeMutex);
+
+		if (write(writer->eventFd, &one, sizeof(one)) < 0) {	// Dosyayı açan worker'ın olay döngüsünün uyandırılması
+			tftp_log_errno("write()");
+		}
+	}
+
+	return NULL;
+}
+
+// Yazma thread'inin oluşturulması (pthread_once ile ilk worker tarafından bir kez çağrılır)
+void tftp_writer_create(void)
+{
+	pthread_t thread;
+
+	if ((writeThreadError = pthread_create(&thread, NULL, tftp_writer_thread, NULL)) == 0) {
+		pthread_detach(thread);
+	}
+}
+
+// Yazma thread'inin ve worker'a tamamlanan işlerin bildirildiği eventfd'nin başlatılması. eventfd, olay döngüsüne kendi
+// adresiyle kaydedilir. Hata durumunda -1 döndürür.
+int tftp_writer_start(void)
+{
+	struct epoll_event event;
+
+	if ((writeEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+		tftp_log_errno("eventfd()");
+		return -1;
+	}
+
+	event.events = EPOLLIN;
+	event.data.ptr = &writeEventFd;
+
+	if (epoll_ctl(epollFilDes, EPOLL_CTL_ADD, writeEventFd, &event) < 0) {
+		tftp_log_errno("epoll_ctl()");
+		return -1;
+	}
+
+	pthread_once(&writeOnce, tftp_writer_create);
+
+	if ((errno = writeThreadError) != 0) {
+		tftp_log_errno("pthread_create()");
+		return -1;
+	}
+
+	return 0;
+}
+
+// WRQ'da yazılacak dosyanın geçici adla oluşturulması. Var olan dosyanın üzerine yazma izni yoksa istek reddedilir.
+// Hata durumunda errno ayarlanmış olarak NULL döndürür.
+tftpWriter *tftp_writer_open(const char *fileName)
+{
+	tftpWriter *writer;
+
+	if (access(fileName, F_OK) == 0 && access(fileName, W_OK) < 0) {	// Var olan, yazılamayan dosya (errno: EACCES)
+		return NULL;
+	}
+
+	if ((writer = calloc(1, sizeof(tftpWriter))) == NULL) {
+		return NULL;
+	}
+
+	if ((writer->fileName = strdup(fileName)) == NULL || (writer->tempName = malloc(strlen(fileName) + 8)) == NULL) {
+		free(writer->fileName);
+		free(writer);
+		return NULL;
+	}
+
+	sprintf(writer->tempName, "%s.XXXXXX", fileName);
+
+	if ((writer->fileDes = mkostemp(writer->tempName, O_CLOEXEC)) < 0) {
+		free(writer->fileName);
+		free(writer->tempName);
+		free(writer);
+		return NULL;
+	}
+
+	fchmod(writer->fileDes, fileCreateMode);	// mkstemp() dosyayı 0600 izniyle oluşturur; fopen() ile aynı izinlere çekilir
+
+	writer->doneList = &writeDoneList;	// Tamamlanma, dosyayı açan worker'ın olay döngüsüne bildirilir
+	writer->eventFd = writeEventFd;
+
+	return writer;
+}
+
+// Client'ın tsize ile bildirdiği boyut kadar alanın dosya için önceden ayrılması. Dosya blok blok büyütülmediğinden parçalanma ve
+// metadata güncellemeleri azalır. Dosya boyutu değişmez (FALLOC_FL_KEEP_SIZE); kullanılmayan alan transfer sonunda bırakılır.
+// Diskte ya da kotada yer yoksa -1 döndürür; dosya sistemi önceden ayırmayı desteklemiyorsa transfer ayırma olmadan sürer.
+int tftp_writer_allocate(tftpWriter *writer, uint64_t size)
+{
+	if (fallocate(writer->fileDes, FALLOC_FL_KEEP_SIZE, 0, size) < 0) {
+		return errno == ENOSPC || errno == EDQUOT || errno == EFBIG ? -1 : 0;
+	}
+
+	writer->preallocated = 1;
+
+	return 0;
+}
+
+// Yazma kuyruğuna iş eklenmesi ve yazma thread'inin uyandırılması
+void tftp_writer_submit(tftpWriteChunk *job)
+{
+	job->next = NULL;
+
+	pthread_mutex_lock(&writeMutex);
+	if (writeQueueTail != NULL) {
+		writeQueueTail->next = job;
+	} else {
+		writeQueueHead = job;
+	}
+	writeQueueTail = job;
+	pthread_cond_signal(&writeCond);
+	pthread_mutex_unlock(&writeMutex);
+}
+
+// Sıradaki DATA bloğunun alınacağı adres. Blok, doldurulmakta olan parçanın sonuna kopyalanmadan alınır; parça yoksa
+// havuzdan alınır, havuzdaki tüm parçalar kullanımdaysa NULL döndürülür (blok oturum tamponuna alınıp doğrudan yazılır).
+uint8_t *tftp_writer_tail(tftpWriter *writer)
+{
+	tftpWriteChunk *chunk;
+	int grow;			// Havuza yeni parça ayrılacaksa 1
+
+	if (writer->chunk == NULL) {
+		pthread_mutex_lock(&writeMutex);
+		if ((chunk = writeFreeList) != NULL) {
+			writeFreeList = chunk->next;
+			grow = 0;
+		} else if ((grow = writeChunkCount < TFTP_WRITE_POOL)) {	// Havuz, sınırına kadar ihtiyaç oldukça büyütülür
+			writeChunkCount++;	// Yer, ayırma kilit dışında yapılırken diğer worker'lar için ayrılır
+		}
+		pthread_mutex_unlock(&writeMutex);
+
+		if (grow) {
+			if ((chunk = malloc(sizeof(tftpWriteChunk))) == NULL ||
+					posix_memalign((void **) &chunk->data, 4096, TFTP_WRITE_CHUNK + TFTP_BLKSIZE_MAXIMUM) != 0) {
+				free(chunk);
+				pthread_mutex_lock(&writeMutex);
+				writeChunkCount--;
+				pthread_mutex_unlock(&writeMutex);
+				return NULL;
+			}
+		}
+
+		if (chunk == NULL) {
+			return NULL;
+		}
+
+		chunk->writer = writer;
+		chunk->command = WRITE_DATA;
+		chunk->length = 0;
+		chunk->offset = writer->offset;
+		writer->chunk = chunk;
+	}
+
+	return writer->chunk->data + writer->chunk->length;
+}
+
+// Alınan bloğun dosyaya eklenmesi. Blok parçanın sonuna alındıysa parça büyütülür; parça TFTP_WRITE_CHUNK boyutuna ulaştığında
+// hizalı ilk TFTP_WRITE_CHUNK bayt yazma thread'ine verilir, taşan kısım yeni parçaya aktarılır. Blok oturum tamponuna
+// alındıysa (havuz dolu) doğrudan yazılır. Daha önce bir yazma hatası oluştuysa ya da veri yazılamazsa -1 döndürür.
+int tftp_writer_append(tftpWriter *writer, const uint8_t *data, size_t length)
+{
+	tftpWriteChunk *chunk = writer->chunk;
+	size_t extra;	// Parçanın TFTP_WRITE_CHUNK sınırını aşan kısmı
+	int error;
+	int result = 0;
+
+	pthread_mutex_lock(&writeMutex);
+	error = writer->error;
+	pthread_mutex_unlock(&writeMutex);
+
+	if (error != 0) {
+		errno = error;
+		return -1;
+	}
+
+	if (chunk == NULL) {	// Havuz dolu: blok oturum tamponundan doğrudan yazılır
+		if (tftp_write_full(writer->fileDes, data, length, writer->offset) < 0) {
+			return -1;
+		}
+		writer->offset += length;
+		return 0;
+	}
+
+	if ((chunk->length += length) < TFTP_WRITE_CHUNK) {
+		return 0;
+	}
+
+	extra = chunk->length - TFTP_WRITE_CHUNK;
+	chunk->length = TFTP_WRITE_CHUNK;
+	writer->offset += TFTP_WRITE_CHUNK;
+	writer->chunk = NULL;
+
+	if (extra > 0) {
+		if (tftp_writer_tail(writer) != NULL) {
+			memcpy(writer->chunk->data, chunk->data + TFTP_WRITE_CHUNK, extra);
+			writer->chunk->length = extra;
+		} else if ((result = tftp_write_full(writer->fileDes, chunk->data + TFTP_WRITE_CHUNK, extra, writer->offset)) == 0) {
+			writer->offset += extra;
+		}
+	}
+
+	tftp_writer_submit(chunk);
+
+	return result;
+}
+
+// Son blok alındığında kalan verinin ve bitirme komutunun yazma thread'ine verilmesi. Dosya kaydedildiğinde
+// tftp_writer_complete() oturumu sonlandırır.
+void tftp_writer_finish(tftpWriter *writer)
+{
+	writer->command.offset = writer->offset + (writer->chunk != NULL ? writer->chunk->length : 0);
+
+	if (writer->chunk != NULL) {
+		tftp_writer_submit(writer->chunk);
+		writer->chunk = NULL;
+	}
+
+	writer->command.writer = writer;
+	writer->command.command = WRITE_FINISH;
+	tftp_writer_submit(&writer->command);
+}
+
+// Yarım kalan transferin iptali. Doldurulan parça yazılmadan havuza döner, geçici dosya yazma thread'inde silinir.
+void tftp_writer_abort(tftpWriter *writer)
+{
+	if (writer->chunk != NULL) {
+		writer->chunk->length = 0;
+		tftp_writer_submit(writer->chunk);
+		writer->chunk = NULL;
+	}
+
+	writer->session = NULL;
+	writer->command.writer = writer;
+	writer->command.command = WRITE_ABORT;
+	tftp_writer_submit(&writer->command);
+}
+
+// Monotonik saatin mikrosaniye cinsinden değerini döndüren fonksiyon (sistem saati değişikliklerinden etkilenmez)
+uint64_t tftp_time_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Zamanlayıcı yığınında iki konumun yer değiştirmesi
+void tftp_timer_swap(unsigned int a, unsigned int b)
+{
+	tftpSession *session = timerHeap[a];
+
+	timerHeap[a] = timerHeap[b];
+	timerHeap[b] = session;
+	timerHeap[a]->timerIndex = a;
+	timerHeap[b]->timerIndex = b;
+}
+
+// Yığındaki elemanın, zaman aşımı anına göre doğru konuma taşınması (yukarı ya da aşağı)
+void tftp_timer_sift(unsigned int index)
+{
+	unsigned int child;
+
+	while (index > 0 && timerHeap[index]->deadline < timerHeap[(index - 1) / 2]->deadline) {	// Yukarı taşıma
+		tftp_timer_swap(index, (index - 1) / 2);
+		index = (index - 1) / 2;
+	}
+
+	while ((child = 2 * index + 1) < timerCount) {	// Aşağı taşıma
+		if (child + 1 < timerCount && timerHeap[child + 1]->deadline < timerHeap[child]->deadline) {
+			child++;
+		}
+		if (timerHeap[index]->deadline <= timerHeap[child]->deadline) {
+			break;
+		}
+		tftp_timer_swap(index, child);
+		index = child;
+	}
+}
+
+// Oturumun zaman aşımının deadline anına kurulması. Oturum yığında değilse eklenir, yığındaysa konumu güncellenir.
+// Yığın için bellek ayrılamazsa -1 döndürür.
+int tftp_timer_schedule(tftpSession *session, uint64_t deadline)
+{
+	tftpSession **heap;
+
+	session->deadline = deadline;
+
+	if (session->timerIndex < 0) {
+		if (timerCount == timerCapacity) {	// Yığın dizisinin büyütülmesi
+			if ((heap = realloc(timerHeap, (timerCapacity ? timerCapacity * 2 : 64) * sizeof(tftpSession *))) == NULL) {
+				return -1;
+			}
+			timerHeap = heap;
+			timerCapacity = timerCapacity ? timerCapacity * 2 : 64;
+		}
+		session->timerIndex = timerCount;
+		timerHeap[timerCount++] = session;
+	}
+
+	tftp_timer_sift(session->timerIndex);
+
+	return 0;
+}
+
+// Oturumun zamanlayıcı yığınından çıkarılması
+void tftp_timer_cancel(tftpSession *session)
+{
+	unsigned int index = session->timerIndex;
+
+	if (session->timerIndex < 0) {
+		return;
+	}
+
+	session->timerIndex = -1;
+
+	if (index != --timerCount) {	// Son eleman boşalan konuma taşınıp yeniden sıralanır
+		timerHeap[index] = timerHeap[timerCount];
+		timerHeap[index]->timerIndex = index;
+		tftp_timer_sift(index);
+	}
+}
+
+// Oturumun sonlandırılması. Soket kapatılır, dosya akışı kapatılır; oturum nesnesi ise aynı olay turunda
+// başka bir olay tarafından hâlâ işaret ediliyor olabileceğinden tur sonunda serbest bırakılmak üzere ayrı listeye alınır.
+void tftp_session_close(tftpSession *session)
+{
+	uint64_t bytes;		// Aktarılan veri miktarı (RRQ'da onaylanan, WRQ'da alınan)
+
+	if (session->state == SESSION_CLOSED) {
+		return;
+	}
+
+	if (session->result != NULL && strcmp(session->result, "ok") == 0) {	// Transfer sayaçlarının güncellenmesi
+		TFTP_METRIC_ADD(transfersCompleted[session->opcode - RRQ], 1);
+	} else {
+		TFTP_METRIC_ADD(transfersFailed[session->opcode - RRQ], 1);
+	}
+	TFTP_METRIC_ADD(sessionsActive, -1);
+	TFTP_METRIC_ADD(durationSum, tftp_time_now() - session->startTime);
+	tftp_metrics_observe(threadMetrics->durationBuckets, (tftp_time_now() - session->startTime) / 1000);
+
+	bytes = session->opcode == RRQ ? (uint64_t) session->blockNumber * session->blockSize : session->transferredBytes;
+	if (session->opcode == RRQ && session->to_close && session->windowCount == 0 && session->blockNumber > 0) {
+		bytes -= session->blockSize - session->dataLength;	// Son blok tam blok boyutunda değildir
+	}
+
+	// Transfer özetinin kaydı
+	tftp_log(LOG_LEVEL_INFO, "client=%s:%u event=transfer op=%s file=\"%s\" mode=%s result=\"%s\" bytes=%" PRIu64 " blocks=%u "
+			"duration_ms=%" PRIu64 " retransmits=%u blksize=%u windowsize=%u srtt_us=%u",
+			session->clientAddr, ntohs(session->client_socket.sin_port), session->opcode == RRQ ? "RRQ" : "WRQ",
+			session->fileName, session->mode == NETASCII ? "netascii" : "octet", session->result != NULL ? session->result : "failed",
+			bytes, session->packetCount, (tftp_time_now() - session->startTime) / 1000, session->retransmitCount,
+			session->blockSize, session->windowSize, session->srtt);
+
+	tftp_timer_cancel(session);		// Oturumun zamanlayıcısının iptali
+	epoll_ctl(epollFilDes, EPOLL_CTL_DEL, session->socketFilDes, NULL);	// Soketin olay döngüsünden çıkarılması
+	close(session->socketFilDes);	// Soketin sonlandırılması
+
+	if (session->fd != NULL) {
+		fclose(session->fd);	// fd FILE nesnesi işaretçisiyle gösterilen dosya akışı kapatılır ve tampon bellekler temizlenir.
+		session->fd = NULL;
+	}
+
+	if (session->fileMap != NULL) {
+		tftp_filemap_release(session->fileMap);	// Dosya eşlemesinin bırakılması
+		session->fileMap = NULL;
+	}
+
+	if (session->writer != NULL) {
+		if (session->state == SESSION_WRQ_FLUSH) {	// Alınan dosyanın kaydı, oturumdan bağımsız olarak tamamlanır
+			session->writer->session = NULL;
+		} else {									// Yarım kalan dosya silinir
+			tftp_writer_abort(session->writer);
+		}
+		session->writer = NULL;
+	}
+
+	// Oturumun aktif listeden çıkarılıp silinecekler listesine eklenmesi
+	if (session->prev != NULL) {
+		session->prev->next = session->next;
+	} else {
+		sessionList = session->next;
+	}
+	if (session->next != NULL) {
+		session->next->prev = session->prev;
+	}
+
+	session->state = SESSION_CLOSED;
+	session->prev = NULL;
+	session->next = closedSessionList;
+	closedSessionList = session;
+	activeSessions--;
+}
+
+// RRQ oturumunda pencerenin gönderilmesi (RFC 7440). Onaylanan son bloktan sonraki windowSize adet blok art arda, TFTP_SEND_BATCH'lik
+// gruplar halinde toplu olarak gönderilir. Eşlenmiş dosyalarda bloklar doğrudan eşlemeden gönderilir; eşlenemeyen dosyalarda daha
+// önce okunmuş bloklar oturum tamponundan yeniden gönderilir, eksik kalanlar dosyadan okunup tampona eklenir.
+// Gönderim başarısız olursa -1 döndürür.
+int tftp_session_send_window(tftpSession *session)
+{
+	const uint8_t *data[TFTP_SEND_BATCH];	// Gruptaki blokların verileri
+	size_t dataLength[TFTP_SEND_BATCH];		// Gruptaki blokların veri boyutları
+	unsigned int batchCount = 0;			// Gruptaki blok sayısı
+	uint8_t *slot;			// Bloğun tampondaki yuvası
+	uint32_t sequence;		// Bloğun sıra numarası
+	uint64_t offset;		// Bloğun dosya içindeki konumu
+	signed int c;
+	unsigned int i;
+	unsigned int j;
+
+	for (i = 1; i <= session->windowSize; i++) {
+		sequence = session->blockNumber + i;
+
+		if (i > session->windowCount && session->to_close) {	// Dosyanın son bloğu daha önce gönderildiyse pencere burada biter
+			break;
+		}
+
+		if (session->fileMap != NULL) {	// Eşlenmiş dosyada bloğun verisi eşlemeden alınır (kopyalama yapılmaz)
+			offset = (uint64_t) (sequence - 1) * session->blockSize;
+			data[batchCount] = session->fileMap->data + offset;
+			dataLength[batchCount] = session->fileMap->size - offset < session->blockSize ? session->fileMap->size - offset : session->blockSize;
+		}
+		else {
+			slot = session->buffer + (sequence % session->windowSize) * session->blockSize;
+			data[batchCount] = slot;
+
+			if (i > session->windowCount) {	// Blok henüz okunmadıysa dosyadan okunur
+				dataLength[batchCount] = fread(slot, 1, session->blockSize, session->fd);	/* Dosyadan en fazla blok boyutu kadar veri
+															yuvaya yüklenir. Okunan veri sayısını döndürür.*/
+			} else {	// Penceredeki son blok dosyanın son bloğu ise kısa, diğerleri tam blok boyutundadır
+				dataLength[batchCount] = (session->to_close && i == session->windowCount) ? session->dataLength : session->blockSize;
+			}
+		}
+
+		if (i > session->windowCount) {	// Pencereye ilk kez giren blok
+			session->windowCount++;
+			session->packetCount++;
+
+			if (dataLength[batchCount] < session->blockSize) { 	// Veri boyutu ile gönderilecek son paket olup/olmadığının kontrolü
+				session->to_close = 1;				// Anlaşılan blok boyutundan az ise son pakettir
+				session->dataLength = dataLength[batchCount];
+			}
+		}
+
+		if (++batchCount == TFTP_SEND_BATCH || i == session->windowSize || (i >= session->windowCount && session->to_close)) {
+			c = tftp_send_data_batch(session->socketFilDes, sequence - batchCount + 1, data, dataLength, batchCount,
+					&session->client_socket, session->socketLength);	// Server'dan Client'a Data paketlerinin gönderimi
+			if (c < 0) {
+				return -1;
+			}
+			TFTP_METRIC_ADD(packetsSent, c);
+			for (j = 0; j < (unsigned int) c; j++) {
+				TFTP_METRIC_ADD(bytesSent, dataLength[j]);
+			}
+			if (c < batchCount) {	// Soket tamponu doldu; pencerenin kalanı zaman aşımında yeniden gönderilir
+				break;
+			}
+			batchCount = 0;
+		}
+	}
+
+	return 0;
+}
+
+// Oturumun zaman aşımının kurulması. Client timeout seçeneği istediyse o süre, istemediyse ölçülen RTT'den hesaplanan RTO kullanılır.
+// Zaman aşımı, transferden vazgeçilecek andan (son ilerlemeden itibaren TFTP_RETRY_NUMBER kez zaman aşımı süresi) sonraya kurulmaz.
+void tftp_session_arm_timer(tftpSession *session)
+{
+	uint64_t timeout = session->timeoutOption ? session->timeoutOption * 1000000ULL : session->rto;
+	uint64_t giveUp = session->lastProgress + TFTP_RETRY_NUMBER *
+			(session->timeoutOption ? session->timeoutOption * 1000000ULL : (uint64_t) TFTP_RTO_MAXIMUM);
+	uint64_t deadline = tftp_time_now() + timeout;
+
+	tftp_timer_schedule(session, deadline < giveUp ? deadline : giveUp);
+}
+
+// Transferin ilerlemesi (yeni blokların onaylanması ya da alınması). sample 1 ise ve son paket yeniden gönderilmediyse (Karn kuralı),
+// paketin gönderilmesinden bu yana geçen süre RTT ölçümü olarak kullanılıp RTO yeniden hesaplanır (RFC 6298).
+void tftp_session_progress(tftpSession *session, int sample)
+{
+	uint64_t now = tftp_time_now();
+	uint32_t rtt = now - session->sentTime;	// Ölçülen gidiş-dönüş süresi
+	uint32_t delta;
+
+	if (sample && !session->retransmitted) {
+		if (session->srtt == 0) {	// İlk ölçüm
+			session->srtt = rtt;
+			session->rttvar = rtt / 2;
+		} else {
+			delta = session->srtt > rtt ? session->srtt - rtt : rtt - session->srtt;
+			session->rttvar = (3 * session->rttvar + delta) / 4;	// RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|
+			session->srtt = (7 * session->srtt + rtt) / 8;			// SRTT = 7/8 SRTT + 1/8 R
+		}
+
+		// RTO = SRTT + max(G, 4 * RTTVAR), alt ve üst sınırlar arasında
+		session->rto = session->srtt + (4 * session->rttvar > TFTP_CLOCK_GRANULARITY ? 4 * session->rttvar : TFTP_CLOCK_GRANULARITY);
+		TFTP_METRIC_ADD(rttSum, rtt);
+		tftp_metrics_observe(threadMetrics->rttBuckets, rtt);
+
+		if (session->rto < TFTP_RTO_MINIMUM) {
+			session->rto = TFTP_RTO_MINIMUM;
+		} else if (session->rto > TFTP_RTO_MAXIMUM) {
+			session->rto = TFTP_RTO_MAXIMUM;
+		}
+	}
+
+	session->lastProgress = now;
+	session->retransmitted = 0;
+}
+
+// Son paketin (RRQ için DATA penceresi, WRQ için ACK) gönderimi ve zaman aşımı süresinin yeniden başlatılması.
+// Gönderim başarısız olursa oturum sonlandırılır ve -1 döndürülür.
+int tftp_session_transmit(tftpSession *session)
+{
+	ssize_t c;	// Giden paketin boyutu (bayt)
+
+	if (session->oackLength > 0) {	// Seçenekler henüz onaylanmadıysa ilk paket OACK'dır
+		c = tftp_send_oack(session->socketFilDes, session->oack, session->oackLength,
+				&session->client_socket, session->socketLength);	// Server'dan Client'a OACK paketi gönderimi
+	} else if (session->state == SESSION_RRQ_WAIT_ACK) {
+		c = tftp_session_send_window(session);	// Server'dan Client'a Data paketlerinin gönderimi
+	} else {
+		c = tftp_send_ack(session->socketFilDes, (uint16_t) session->blockNumber,
+				&session->client_socket, session->socketLength);	// Server'dan Client'a ACK paketi gönderimi
+	}
+
+	if (c < 0) {		// Hata Kontrolü: Paketin gönderilip gönderilemediğinin kontrolü
+		session->result = "send failed";
+		tftp_session_close(session);
+		return -1;
+	}
+
+	session->sentTime = tftp_time_now();
+	tftp_session_arm_timer(session);
+
+	return 0;
+}
+
+// Son paketin yeniden gönderimi. İlerleme olmadan geçen süre, transferden vazgeçme süresini aştıysa oturum sonlandırılır.
+// RTO her yeniden gönderimde iki katına çıkarılır (üstel geri çekilme); yeni bir RTT ölçümü yapılana kadar bu değer korunur.
+void tftp_session_retransmit(tftpSession *session)
+{
+	uint64_t giveUp = session->lastProgress + TFTP_RETRY_NUMBER *
+			(session->timeoutOption ? session->timeoutOption * 1000000ULL : (uint64_t) TFTP_RTO_MAXIMUM);
+
+	if (tftp_time_now() >= giveUp) {	// Paket gönderimi defalarca denenip başarısız olunduğunda transfer sonlandırılır
+		session->result = "timeout";
+		TFTP_METRIC_ADD(timeouts, 1);
+		tftp_session_close(session);
+		return;
+	}
+
+	if (!session->timeoutOption) {
+		session->rto = session->rto * 2 < TFTP_RTO_MAXIMUM ? session->rto * 2 : TFTP_RTO_MAXIMUM;
 	}
 
-	return receivedMessageSize;		// Gelen verinin, bayt cinsinden boyutunun geri döndürülmesi
+	session->retransmitted = 1;
+	session->retransmitCount++;
+	TFTP_METRIC_ADD(retransmits, 1);
+	TFTP_LOG_TRACE("client=%s:%u event=retransmit block=%u rto_us=%u", session->clientAddr, ntohs(session->client_socket.sin_port),
+			(uint16_t) session->blockNumber, session->rto);
+	tftp_session_transmit(session);
 }
 
-// Client'a DATA paketinin gönderimini sağlayan olan fonksiyon.  Gönderdiği verinin boyutunu döndürür.
-signed int tftp_send_data(int socketID, uint16_t blockNumber, uint8_t *data, ssize_t dataLength, struct sockaddr_in *socket, socklen_t socketLength)
+// Onaylanan seçeneğin oturumun OACK paketine eklenmesi. OACK tamponu yetersizse seçenek eklenmez ve -1 döndürülür.
+int tftp_oack_append(tftpSession *session, const char *name, unsigned long value)
 {
-	tftpMessage message;	// tftpMessage bileşimindeki veri türlerinin, fonksiyon içerisinde kullanıma hazır hale getirilmesi
-	signed int sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun kaydedileceği değişken
+	char valueString[24];	// Seçenek değerinin metin hali
+	size_t nameLength = strlen(name) + 1;
+	size_t valueLength = snprintf(valueString, sizeof(valueString), "%lu", value) + 1;
 
-	message.opcode = htons(DATA); 				// Opcode verisinin, bellekte, ağ bayt sıralamasına göre DATA olarak tutulmasını sağlar
-	message.data.blockNumber = htons(blockNumber); 	// Blok numarası verisinin, bellekte ağ bayt sıralamasına göre (MSB) tutulmasını sağlar
-	memcpy(message.data.data, data, dataLength); 	// dataLength kadar uzunluktaki data bellek verisi, union data.data'ya kaydedildi
+	if (session->oackLength == 0) {		// İlk seçenek eklenirken paketin opcode alanı yazılır
+		((tftpMessage *) session->oack)->opcode = htons(OACK);
+		session->oackLength = 2;
+	}
 
-	if ((sentSize = sendto(socketID, &message, dataLength + TFTP_DATA_MINIMUM, 0, (struct sockaddr *) socket, socketLength)) < 0) { // Paket gönderimi
-		perror("Server: sendto()");	// Paket gönderiminin hata kontrolü. Alınan hatanın açıklamasını yazdırır. (Hata, errno değişkeninde saklanır)
+	if (session->oackLength + nameLength + valueLength > sizeof(session->oack)) {
+		return -1;
 	}
 
-	return sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun geri döndürülmesi
+	memcpy(session->oack + session->oackLength, name, nameLength);		// Seçenek adı, 0 (1 bayt)
+	session->oackLength += nameLength;
+	memcpy(session->oack + session->oackLength, valueString, valueLength);	// Seçenek değeri, 0 (1 bayt)
+	session->oackLength += valueLength;
+
+	return 0;
 }
 
-// Client'a ACK paketinin gönderimini sağlayan fonksiyon. Gönderdiği verinin boyutunu döndürür.
-signed short tftp_send_ack(int socketID, uint16_t blockNumber, struct sockaddr_in *socket, socklen_t socketLength)
+// RRQ/WRQ paketinde transfer modundan sonra gelen seçeneklerin (RFC 2347) işlenmesi. options: ilk seçenek adının adresi,
+// optionsEnd: paketin son baytının (0) adresi. Desteklenen seçenekler oturuma uygulanıp OACK paketine eklenir, tanınmayan
+// seçenekler yok sayılır. Geçersiz bir seçenek değerinde hata kodu errorCode'a, hata mesajı errorString'e yazılıp -1 döndürülür.
+int tftp_options_negotiate(tftpSession *session, char *options, char *optionsEnd, int *errorCode, const char **errorString)
 {
-	tftpMessage message;	// tftpMessage bileşimindeki veri türlerinin, fonksiyon içerisinde kullanıma hazır hale getirilmesi
-	signed short sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun kaydedileceği değişken
+	char *name;			// Seçenek adı
+	char *value;		// Seçenek değeri (metin)
+	char *valueEnd;		// strtoul() ile sayıya çevrilen kısmın sonu
+	unsigned long number;
+	struct stat fileStat;	// Eşlenemeyen dosyanın boyutu için
 
-	message.opcode = htons(ACK); 					// Opcode verisinin, bellekte, ağ bayt sıralamasına göre ACK olarak tutulmasını sağlar
-	message.ack.blockNumber = htons(blockNumber);	// Blok numarası verisinin, bellekte ağ bayt sıralamasına göre (MSB) tutulmasını sağlar
+	*errorCode = 8;		// 8: Seçenek reddi (RFC 2347)
 
-	if ((sentSize = sendto(socketID, &message, sizeof(message.ack), 0, (struct sockaddr *) socket, socketLength)) < 0) { // Paket gönderimi
-		perror("Server: sendto()"); // Paket gönderiminin hata kontrolü. Alınan hatanın açıklamasını yazdırır. (Hata, errno değişkeninde saklanır)
-	}
+	for (name = options; name < optionsEnd; name = value + strlen(value) + 1) {
+		value = name + strlen(name) + 1;
 
-	return sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun geri döndürülmesi
-}
+		if (value > optionsEnd) {	// Değeri olmayan son seçenek yok sayılır
+			break;
+		}
 
-// Client'a ERROR paketinin gönderimini sağlayan fonksiyon. Gönderdiği verinin boyutunu döndürür.
-signed short tftp_server_send_error(int socketID, int errorCode, char *errorString, struct sockaddr_in *socket, socklen_t socketLength)
-{
-	tftpMessage message;	// tftpMessage bileşimindeki veri türlerinin, fonksiyon içerisinde kullanıma hazır hale getirilmesi
-	signed short sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun kaydedileceği değişken
+		number = strtoul(value, &valueEnd, 10);
 
-	if(strlen(errorString) >= TFTP_DATA_DEFAULT) { // Hata mesajı boyutunun sınırının aşılma durumunun kontrolü
-		fprintf(stderr, "Server: tftpServerSendError(): Error message is too long!\n");
-		return -1;
-	}
+		if (strcasecmp(name, "blksize") == 0) {	// Blok boyutu seçeneği (RFC 2348)
+			if (*value == '\0' || *valueEnd != '\0' || number < TFTP_BLKSIZE_MINIMUM) {
+				*errorString = "Invalid blksize option";
+				return -1;
+			}
+			if (number > blockSizeLimit) {	// Server sınırından büyük istenen blok boyutu sınıra indirilerek onaylanır
+				number = blockSizeLimit;
+			}
+			session->blockSize = number;
+			tftp_oack_append(session, "blksize", number);
+		}
 
-	message.opcode = htons(ERROR);				// Opcode verisinin bellekte ağ bayt sıralamasına göre ERROR olarak tutulmasını sağlar
-	message.error.errorCode = htons(errorCode);		// Hata kodu numarasının, bellekte tutulan değişkene ağ bayt sıralamasına göre kaydı
-	strcpy(message.error.errorMessage, errorString);	// Hata mesajının, bellekteki errorMessage değişkenine kopyalanması
+		else if (strcasecmp(name, "windowsize") == 0) {	// Pencere boyutu seçeneği (RFC 7440)
+			if (*value == '\0' || *valueEnd != '\0' || number < 1 || number > TFTP_WINDOWSIZE_MAXIMUM) {
+				*errorString = "Invalid windowsize option";
+				return -1;
+			}
+			if (number > windowSizeLimit) {	// Server sınırından büyük istenen pencere boyutu sınıra indirilerek onaylanır
+				number = windowSizeLimit;
+			}
+			session->windowSize = number;
+			tftp_oack_append(session, "windowsize", number);
+		}
 
-	if ((sentSize = sendto(socketID, &message, strlen(errorString) + 1, 0, (struct sockaddr *) socket, socketLength)) < 0)	// Paket gönderimi
-	{																								// ve hata kontrolü
-		perror("SERVER: sendto()");	// Paket gönderiminin hata kontrolü. Alınan hatanın açıklamasını yazdırır. (Hata, errno değişkeninde saklanır)
+		else if (strcasecmp(name, "timeout") == 0) {	// Zaman aşımı seçeneği (RFC 2349)
+			if (*value == '\0' || *valueEnd != '\0' || number < 1 || number > TFTP_TIMEOUT_MAXIMUM) {
+				*errorString = "Invalid timeout option";
+				return -1;
+			}
+			session->timeoutOption = number;
+			tftp_oack_append(session, "timeout", number);
+		}
+
+		else if (strcasecmp(name, "tsize") == 0) {	// Transfer boyutu seçeneği (RFC 2349)
+			if (*value == '\0' || *valueEnd != '\0' || number == ULONG_MAX) {
+				*errorString = "Invalid tsize option";
+				return -1;
+			}
+			if (session->opcode == RRQ) {	// RRQ'da Client 0 gönderir, dosyanın boyutu bildirilir
+				if (session->fileMap != NULL) {		// Boyut, dosya eşlemesinden okunur
+					number = session->fileMap->size;
+				} else if (fstat(fileno(session->fd), &fileStat) == 0) {
+					number = fileStat.st_size;
+				} else {
+					continue;
+				}
+			} else if (uploadQuota != 0 && number > uploadQuota) {	// WRQ'da bildirilen boyut kotayı aşıyorsa transfer başlamadan reddedilir
+				*errorCode = 3;		// 3: Disk dolu ya da ayrılan alan aşıldı
+				*errorString = "File exceeds upload quota";
+				return -1;
+			}
+			session->transferSize = number;
+			tftp_oack_append(session, "tsize", number);
+		}
 	}
 
-	return sentSize;	// Gönderilen verinin, bayt cinsinden boyutunun geri döndürülmesi
+	return 0;
 }
 
-// WRQ ve RRQ Paketlerinin İşlendiği Fonksiyon
+// WRQ ve RRQ Paketlerinin İşlendiği Fonksiyon. İsteği doğrular, yeni bir oturum oluşturur ve ilk paketi gönderir;
+// transferin geri kalanı olay döngüsü tarafından yürütülür.
 void tftp_server_handle_request(tftpMessage *message, signed int messageByte, struct sockaddr_in *client_socket, socklen_t socketLength)
 {
-	int16_t socketFilDes;	// Soketin dosya betimleyicisi (Socket File Descriptor)
+	int socketFilDes;		// Soketin dosya betimleyicisi (Socket File Descriptor)
 	uint16_t opcode;		// İşlem kodunu belirten değişken (opcode)
 	char mode; 			// Transfer modunu belirten değişken
 	char *mode_s;			// Transfer modunun string olarak tutulacağı değişken
 	char *fileName;		// ? Aktarılacak dosya adı ve transfer modunu barındıracak değişken
 	char *fileNameEnd;		// ? Aktarılacak dosya adını barındıracak değişken
 
-	FILE *fd;				// Transferi gerçekleşmekte olan dosya işlemlerinin takibi için kullanılan dosya struct'ı
+	FILE *fd = NULL;		// Transferi gerçekleşmekte olan dosya işlemlerinin takibi için kullanılan dosya struct'ı
+	int fileDes;			// RRQ'da okunacak dosyanın betimleyicisi
+	tftpFileMap *fileMap = NULL;	// RRQ'da okunacak dosyanın paylaşılan eşlemesi
+	tftpWriter *writer = NULL;		// WRQ'da yazılacak dosya
+	char clientAddr[INET_ADDRSTRLEN];	// Client ip adresinin yazdırılabilir hali
+	tftpSession *session = NULL;	// Transfer için oluşturulacak oturum nesnesi
+	const char *errorString;	// Seçenek işlenirken oluşan hatanın açıklaması
+	int errorCode;				// Seçenek işlenirken oluşan hatanın TFTP hata kodu
+	struct epoll_event event;	// Oturum soketinin olay döngüsüne kaydı için kullanılan struct
+
+	inet_ntop(AF_INET, &client_socket->sin_addr, clientAddr, sizeof(clientAddr));
 
 	// Soket kurulumu ve dosya betimleyicisinin kaydedilmesi
-	socketFilDes = tftp_socket_start();
+	if ((socketFilDes = tftp_socket_start()) < 0) {
+		tftp_log(LOG_LEVEL_ERROR, "client=%s:%u event=reject reason=\"transfer socket could not be created\"", clientAddr, ntohs(client_socket->sin_port));
+		return;
+	}
 
 	// Client'ın gönderdiği paketin çözümleme işlemleri
 	fileName = message->request.fileName_and_mode;		// fileName'in işaret ettiği adresten itibaren 514 bayt'lık yer ayrıldı
 	fileNameEnd = &fileName[messageByte - 2 - 1];
 
 	if (*fileNameEnd != '\0') { 	// Hata Kontrolü: Dosya adının ve transfer modunun geçerliliğinin kontrolü
-		printf("%s.%u: Invalid fileName or mode\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
+		tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject reason=\"invalid file name or mode\"", clientAddr, ntohs(client_socket->sin_port));
 		tftp_server_send_error(socketFilDes, 0, "Invalid fileName or mode", client_socket, socketLength);
-		exit(EXIT_FAILURE);
+		goto request_failed;
 	}
 
 	mode_s = strchr(fileName, '\0') + 1;	// Transfer modunun olduğu adresin bulunup mode_s değişkenine kaydedilmesi (netascii, octet, mail)
 
 	if (mode_s > fileNameEnd) {
-		printf("%s.%u: transfer mode not specified\n",
-				inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
+		tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject reason=\"transfer mode not specified\"",
+				clientAddr, ntohs(client_socket->sin_port));
 		tftp_server_send_error(socketFilDes, 0, "Transfer mode not specified", client_socket, socketLength);
-		exit(EXIT_FAILURE);
+		goto request_failed;
 	}
 
 	if(strncmp(fileName, "../", 3) == 0 || strstr(fileName, "/../") != NULL ||
 			(fileName[0] == '/' && strncmp(fileName, fileBaseDirectory, strlen(fileBaseDirectory)) != 0)) {
-		printf("%s.%u: fileName outside base directory\n",
-				inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
+		tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject file=\"%s\" reason=\"outside base directory\"",
+				clientAddr, ntohs(client_socket->sin_port), fileName);
 		tftp_server_send_error(socketFilDes, 0, "FileName outside base directory", client_socket, socketLength);
-		exit(EXIT_FAILURE);
+		goto request_failed;
 	}
 
 	opcode = ntohs(message->opcode);					// İşlem kodu kaydı
-	fd = fopen(fileName, opcode == RRQ ? "r" : "w"); 	/* Dosya işlemleri için Client'tan gelen pakete göre izin alınır (Okuma/Yazma)
-														Akışı kontrol eden nesneye işaretçi döner */
-	if (fd == NULL) {
-		perror("server: fopen()");
+
+	if (opcode == RRQ) {	// Okunacak dosya önce paylaşılan eşleme önbelleğinden istenir, eşlenemezse akış olarak açılır
+		if ((fileDes = open(fileName, O_RDONLY)) >= 0) {
+			if ((fileMap = tftp_filemap_acquire(fileDes)) != NULL) {
+				close(fileDes);		// Eşleme, dosya betimleyicisi kapatıldıktan sonra da geçerlidir
+			} else if ((fd = fdopen(fileDes, "r")) == NULL) {
+				close(fileDes);
+			}
+		}
+	} else {
+		writer = tftp_writer_open(fileName); 	// Yazılacak veri, transfer tamamlanana kadar geçici dosyada tutulur
+	}
+
+	if (fd == NULL && fileMap == NULL && writer == NULL) {
+		tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject file=\"%s\" reason=\"%s\"",
+				clientAddr, ntohs(client_socket->sin_port), fileName, strerror(errno));
 		tftp_server_send_error(socketFilDes, errno, strerror(errno), client_socket, socketLength);
-		exit(EXIT_FAILURE);
+		goto request_failed;
 	}
 
 	// Harf duyarlılığı olmadan, gelen mesajın hangi transfer modunda iletildiğinin sayısal karşılığının
 	mode = strcasecmp(mode_s, "netascii")	?	(strcasecmp(mode_s, "octet") ? 0 : OCTET) :	NETASCII;
 
 	if (mode == 0) {
-		printf("%s.%u: Invalid transfer mode (Mail mode is not supported)\n",
-				inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
+		tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject file=\"%s\" mode=%s reason=\"unsupported transfer mode\"",
+				clientAddr, ntohs(client_socket->sin_port), fileName, mode_s);
 		tftp_server_send_error(socketFilDes, 0, "Invalid transfer mode", client_socket, socketLength);
-		exit(EXIT_FAILURE);
+		goto request_failed;
 	}
 
-	printf("\n%s.%u: CON packet received. Request: \"%s '%s' %s\"\n",			// Server'a istek paketi geldiğini türüyle birlikte kullanıcıya bildirir
-			inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port),
-			ntohs(message->opcode) == RRQ ? "get" : "put", fileName, mode_s);
+	tftp_log(LOG_LEVEL_INFO, "client=%s:%u event=request op=%s file=\"%s\" mode=%s",	// Server'a istek paketi geldiğinin türüyle birlikte kaydı
+			clientAddr, ntohs(client_socket->sin_port), opcode == RRQ ? "RRQ" : "WRQ", fileName, mode_s);
 
 	// TODO: NETASCII formatı için handler oluşturulmadı
 
-	if (opcode == RRQ) {	// Server'dan veri okumak için Client'tan istek gelmesi halinde izlenen adımlar
-		tftpMessage message;				// tftpMessage bileşimindeki veri türlerinin, fonksiyon içerisinde kullanıma hazır hale getirilmesi
+	if ((session = calloc(1, sizeof(tftpSession))) == NULL || (session->fileName = strdup(fileName)) == NULL) {	// Oturum nesnesi için bellek ayrılması
+		tftp_log_errno("calloc()");
+		tftp_server_send_error(socketFilDes, 0, "Server out of memory", client_socket, socketLength);
+		goto request_failed;
+	}
+
+	session->socketFilDes = socketFilDes;
+	session->client_socket = *client_socket;
+	session->socketLength = socketLength;
+	memcpy(session->clientAddr, clientAddr, sizeof(clientAddr));
+	session->opcode = opcode;
+	session->fd = fd;
+	session->fileMap = fileMap;
+	session->writer = writer;
+	session->mode = mode;
+	session->startTime = tftp_time_now();
+	session->blockSize = TFTP_DATA_DEFAULT;
+	session->windowSize = 1;
+	session->timerIndex = -1;
+	session->rto = TFTP_RTO_INITIAL;
+	session->lastProgress = tftp_time_now();
+
+	// Transfer modundan sonra gelen seçeneklerin işlenmesi (blksize vb.)
+	if (tftp_options_negotiate(session, mode_s + strlen(mode_s) + 1, fileNameEnd, &errorCode, &errorString) < 0) {
+		tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject file=\"%s\" reason=\"%s\"",
+				clientAddr, ntohs(client_socket->sin_port), fileName, errorString);
+		tftp_server_send_error(socketFilDes, errorCode, (char *) errorString, client_socket, socketLength);
+		goto request_failed;
+	}
+
+	// WRQ'da bildirilen boyut kadar alan önceden ayrılır; yer yoksa transfer başlamadan reddedilir
+	if (writer != NULL && session->transferSize > 0 && tftp_writer_allocate(writer, session->transferSize) < 0) {
+		tftp_log_errno("fallocate()");
+		tftp_server_send_error(socketFilDes, 3, "Disk full or allocation exceeded", client_socket, socketLength);
+		goto request_failed;
+	}
 
-		uint16_t blockNumber = 0;			// Transfer boyunca aktarılan paket sayısının kontrol edileceği değişken
-		uint8_t data[TFTP_DATA_DEFAULT];		// Aktarılacak veri boyutunun tanımlanması
-		ssize_t dlen;						// Verinin bayt cinsinden boyutunun kaydedileceği değişken
-		ssize_t c;						// Gelecek/Gidecek paket boyutunun (bayt) kontrolü
+	// Paket tamponunun anlaşılan blok boyutuna göre ayrılması (WRQ'da gelen DATA paketi için, eşlenemeyen dosyalarda RRQ
+	// penceresindeki her blok için bir yuva). Eşlenmiş dosyalarda bloklar doğrudan eşlemeden gönderildiğinden tampon ayrılmaz.
+	if (fileMap == NULL && (session->buffer = malloc(opcode == RRQ ? (size_t) session->windowSize * session->blockSize :
+			session->blockSize + TFTP_DATA_MINIMUM)) == NULL) {
+		tftp_log_errno("malloc()");
+		tftp_server_send_error(socketFilDes, 0, "Server out of memory", client_socket, socketLength);
+		goto request_failed;
+	}
 
-		unsigned int countdownRetry;		// Bir paketin gönderimi için maksimum deneme sayısını belirten değişken
-		int to_close = 0;				// İşlem tamamlandığında döngüden çıkmak için kullanılacak değişken
+	event.events = EPOLLIN;		// Sokete paket geldiğinde olay üretilmesi
+	event.data.ptr = session;	// Olay geldiğinde hangi oturumun ilerletileceğinin belirlenmesi
 
-		while (!to_close) {
+	if (epoll_ctl(epollFilDes, EPOLL_CTL_ADD, socketFilDes, &event) < 0) {	// Hata Kontrolü: Soketin olay döngüsüne eklenmesi
+		tftp_log_errno("epoll_ctl()");
+		goto request_failed;
+	}
 
-			dlen = fread(data, 1, sizeof(data), fd); /* Belleğin fp ile işaret edilen adresinden, data'nın toplam (bayt) boyutu adedince veri,
-													 1'er bayt'lar halinde, data (tampon belleği) adresine yüklenir. Okunan veri sayısını döndürür.*/
-			blockNumber++;		// Verinin blok (paket) numarasının 1 artışı (counter)
+	// Oturumun aktif oturumlar listesinin başına eklenmesi
+	session->next = sessionList;
+	if (sessionList != NULL) {
+		sessionList->prev = session;
+	}
+	sessionList = session;
+	activeSessions++;
+	TFTP_METRIC_ADD(sessionsActive, 1);
+	TFTP_METRIC_ADD(transfersStarted[opcode - RRQ], 1);
 
-			if (dlen < TFTP_DATA_DEFAULT) { 	// Veri boyutu ile gönderilecek son paket olup/olmadığının kontrolü
-				to_close = 1;				// TFTP_DATA_DEFAULT'dan az ise son pakettir
-			}
+	session->state = opcode == RRQ ? SESSION_RRQ_WAIT_ACK : SESSION_WRQ_WAIT_DATA;
 
-			for (countdownRetry = TFTP_RETRY_NUMBER; countdownRetry; countdownRetry--) {	// Paket gönderiminin denenme sayısının sınırlandırması
+	// Seçenek onaylandıysa OACK gönderilir; RRQ'da OACK'ya ACK (0) geldiğinde ilk DATA penceresi gönderilir. Seçenek yoksa
+	// RRQ'da ilk DATA paketi, WRQ'da isteğe karşılık ACK (0) paketi gönderilir.
+	if (writer != NULL) {
+		writer->session = session;
+	}
 
-				c = tftp_send_data(socketFilDes, blockNumber, data, dlen, client_socket, socketLength);	// Server'dan Client'a Data paketi gönderimi
-																										// c'de giden paketin boyutu (bayt) saklanır
-				if (c < 0) {		// Hata Kontrolü: Paketin gönderilip gönderilemediğinin kontrolü
-					printf("%s.%u: transfer killed\n",inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-					exit(EXIT_FAILURE);
-				}
+	tftp_session_transmit(session);
 
-				c = tftp_receive_message(socketFilDes, &message, client_socket, &socketLength);	// Client'tan ACK paketi alımı
-																								// c'de gelen paketin boyutu (bayt) saklanır
-				if (c >= 0 && c < 4) {	// Hata Kontrolü: Gelen paket boyutunun kontrolü
-					printf("%s.%u: received packet with invalid size\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-					tftp_server_send_error(socketFilDes, 0, "Invalid request size", client_socket, socketLength);
-					exit(EXIT_FAILURE);
-				}
+	return;
 
-				if (c >= 4) {			// Başarılı RRQ paket alımı
-					printf("%s.%u: RRQ packet received. (%u)\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port), blockNumber);
-					break;
-				}
+request_failed:	// İstek reddedildiğinde, oturum oluşturulmadan önce ayrılan kaynaklar serbest bırakılır
+	TFTP_METRIC_ADD(requestsRejected, 1);
+	if (session != NULL) {
+		free(session->fileName);
+		free(session->buffer);
+		free(session);
+	}
+	if (fd != NULL) {
+		fclose(fd);
+	}
+	if (fileMap != NULL) {
+		tftp_filemap_release(fileMap);
+	}
+	if (writer != NULL) {
+		tftp_writer_abort(writer);
+	}
+	close(socketFilDes);	// Soketin sonlandırılması
+}
 
-				if (errno != EAGAIN) {	// EAGAIN hatası değilse transferi sonlandır (Resource temporarily unavailable ise gönderim tekrar denenecek)
-					printf("%s.%u: transfer killed\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-					exit(EXIT_FAILURE);
-				}
-			}
+// RRQ oturumunda Client'tan gelen paketin işlenmesi
+void tftp_session_handle_rrq(tftpSession *session, tftpMessage *message)
+{
+	uint16_t acked;		// ACK'nın, onaylanan son bloktan itibaren kaç yeni bloğu onayladığı
 
-			if (!countdownRetry) {		// 5 kez gönderim denenip başarısız olunduğunda transferi sonlandırmak için kullanılır
-				printf("%s.%u: transfer timed out\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-				exit(EXIT_FAILURE);
-			}
+	if (ntohs(message->opcode) != ACK) {		// Hata Kontrolü: Gelen paketin ACK olup olmadığının kontrolü
+		session->result = "invalid message";
+		tftp_server_send_error(session->socketFilDes, 0, "Invalid message during transfer", &session->client_socket, session->socketLength);
+		tftp_session_close(session);
+		return;
+	}
 
-			if (ntohs(message.opcode) == ERROR) {		// Hata Kontrolü: Hata paketi geldiğinde transferi sonlandırır
-				printf("%s.%u: error message received: %u %s\n",
-						inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port),
-			 			ntohs(message.error.errorCode), message.error.errorMessage);
-				exit(EXIT_FAILURE);
-			}
+	if (session->oackLength > 0 && ntohs(message->ack.blockNumber) == 0) {	// OACK'nın ACK (0) ile onaylanması; ilk pencere gönderilir
+		session->oackLength = 0;
+		tftp_session_progress(session, 1);
+		tftp_session_transmit(session);
+		return;
+	}
 
-			if (ntohs(message.opcode) != ACK) {		// Hata Kontrolü: Gelen paketin ACK olup olmadığının kontrolü
-				printf("%s.%u: invalid message during transfer received\n",
-						inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-				tftp_server_send_error(socketFilDes, 0, "Invalid message during transfer", client_socket, socketLength);
-				exit(EXIT_FAILURE);
-			}
+	acked = ntohs(message->ack.blockNumber) - (uint16_t) session->blockNumber;
 
-			if (ntohs(message.ack.blockNumber) != blockNumber) {	// Hata Kontrolü: ACK'nın blok numarası ile
-				printf("%s.%u: invalid ack number received\n",		// gönderilen Data'daki blok numarasının uymaması
-						inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-				tftp_server_send_error(socketFilDes, 0, "Invalid ack number", client_socket, socketLength);
-				exit(EXIT_FAILURE);
-			}
+	if (acked == 0) {	// Onaylanmış son bloğa ait tekrarlanan ACK
+		if (session->windowSize > 1) {	// Pencerede kayıp var: Client, sırayla aldığı son bloğu onaylıyor; pencere baştan gönderilir
+			session->retransmitted = 1;
+			session->retransmitCount++;
+			TFTP_METRIC_ADD(retransmits, 1);
+			tftp_session_transmit(session);
+		}
+		return;			// Pencere boyutu 1 ise yok sayılır (Sorcerer's Apprentice hatasının önlenmesi)
+	}
+
+	if (acked > session->windowCount) {	// Hata Kontrolü: ACK'nın blok numarası ile
+		session->result = "invalid ack number";		// gönderilen Data'lardaki blok numaralarının uymaması
+		tftp_server_send_error(session->socketFilDes, 0, "Invalid ack number", &session->client_socket, session->socketLength);
+		tftp_session_close(session);
+		return;
+	}
 
-		}	// while(!to_close){} bitiş
-		printf("\n%s.%u: DONE! Transfer completed with %u sent packet(s).\n",	// Transferin tamamlandığına dair onay mesajı
-				inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port), blockNumber);
-	} // if(opcode == RRQ) bitiş
+	TFTP_LOG_TRACE("client=%s:%u event=ack block=%u", session->clientAddr, ntohs(session->client_socket.sin_port), ntohs(message->ack.blockNumber));
 
-	else if (opcode == WRQ) {	// Server'a veri yazmak için Client'tan istek gelmesi halinde izlenen adımlar
-		tftpMessage message;			// tftpMessage bileşimindeki veri türlerinin, fonksiyon içerisinde kullanıma hazır hale getirilmesi
+	session->blockNumber += acked;		// Pencere, onaylanan bloklar kadar ilerletilir
+	session->windowCount -= acked;		// Onaylanmayan bloklar (kısmi pencere) tamponda kalır ve yeniden gönderilir
+	tftp_session_progress(session, 1);
 
-		uint16_t blockNumber = 0;		// Transfer boyunca aktarılan paket sayısının kontrol edileceği değişken
-		ssize_t c;						// Gelecek/Gidecek paket boyutunun (bayt) kontrolü
+	if (session->to_close && session->windowCount == 0) {	// Son paketin ACK'sı alındığında transfer tamamlanır
+		session->result = "ok";		// Transferin tamamlandığı, oturum sonlandırılırken özet kaydıyla bildirilir
+		tftp_session_close(session);
+		return;
+	}
 
-		unsigned int countdownRetry;	// Bir paketin gönderimi için maksimum deneme sayısını belirten değişken
-		int to_close = 0;				// İşlem tamamlandığında döngüden çıkmak için kullanılacak değişken
+	tftp_session_transmit(session);
+}
 
-		c = tftp_send_ack(socketFilDes, blockNumber, client_socket, socketLength);	// Client'ın isteğine karşılık ACK paketi gönderimi
+// WRQ oturumunda Client'tan gelen paketin işlenmesi. data, paketin verisinin alındığı adrestir (yazma parçası ya da oturum tamponu).
+void tftp_session_handle_wrq(tftpSession *session, tftpMessage *message, const uint8_t *data, ssize_t c)
+{
+	if (ntohs(message->opcode) != DATA) {	// Hata Kontrolü: Gelen paketin Data türünde olup olmadığının kontrolü
+		session->result = "invalid message";
+		tftp_server_send_error(session->socketFilDes, 0, "Invalid message during transfer", &session->client_socket, session->socketLength);
+		tftp_session_close(session);
+		return;
+	}
 
-		if (c < 0) {		// Hata Kontrolü: ACK paketinin, gönderilip gönderilemediğinin kontrolü
-			printf("%s.%u: transfer killed\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-			exit(EXIT_FAILURE);
+	if (ntohs(message->data.blockNumber) != (uint16_t) (session->blockNumber + 1)) {	// Beklenen bloktan farklı blok
+		if (session->windowSize > 1) {	// Pencerede kayıp var: sırayla alınan son blok bir kez onaylanır, Client pencereyi
+			if (!session->gapAcked) {	// oradan yeniden gönderir. Kayıptan sonra gelen diğer bloklar yok sayılır.
+				session->gapAcked = 1;
+				session->windowCount = 0;
+				session->retransmitted = 1;
+				session->retransmitCount++;
+				TFTP_METRIC_ADD(retransmits, 1);
+				tftp_session_transmit(session);
+			}
+			return;
 		}
 
-		while (!to_close) {
+		if (ntohs(message->data.blockNumber) == (uint16_t) session->blockNumber && session->oackLength == 0) {	// Son ACK kaybolduğu
+			session->retransmitted = 1;						// için tekrarlanan DATA'ya ACK yeniden gönderilir
+			session->retransmitCount++;
+			TFTP_METRIC_ADD(retransmits, 1);
+			tftp_session_transmit(session);
+			return;
+		}
 
-			for (countdownRetry = TFTP_RETRY_NUMBER; countdownRetry; countdownRetry--) {	// Paket gönderiminin denenme sayısının sınırlandırması
+		session->result = "invalid block number";	// Hata Kontrolü: Gelen Data'daki blok numarası ile gönderilen ACK'nın blok numarasının uymaması
+		tftp_server_send_error(session->socketFilDes, 0, "Invalid block number", &session->client_socket, session->socketLength);
+		tftp_session_close(session);
+		return;
+	}
 
-				c = tftp_receive_message(socketFilDes, &message, client_socket, &socketLength); // Server'dan Client'a Data paketi gönderimi
+	session->blockNumber++;	// Verinin blok (paket) numarasının 1 artışı (counter)
+	session->packetCount++;
+	session->windowCount++;
+	session->gapAcked = 0;
+	session->oackLength = 0;	// İlk DATA paketi OACK'nın onayı yerine geçer
+	tftp_session_progress(session, session->windowCount == 1);	// RTT yalnızca ACK'dan sonraki ilk bloktan ölçülür
+	TFTP_LOG_TRACE("client=%s:%u event=data block=%u size=%zd", session->clientAddr, ntohs(session->client_socket.sin_port),
+			(uint16_t) session->blockNumber, c - 4);
+
+	if (c - 4 < session->blockSize) {	// Anlaşılan blok boyutundan kısa DATA son pakettir
+		session->to_close = 1;
+	}
 
-				if (c >= 0 && c < 4) { // Hata Kontrolü: Gelen paket boyutunun kontrolü
-					printf("%s.%u: message with invalid size received\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-					tftp_server_send_error(socketFilDes, 0, "Invalid request size", client_socket, socketLength);
-					exit(EXIT_FAILURE);
-				}
+	TFTP_METRIC_ADD(packetsReceived, 1);
+	TFTP_METRIC_ADD(bytesReceived, c - 4);
 
-				if (c >= 4) {	// Başarılı WRQ paket alımı
-					break;
-				}
+	if ((session->transferredBytes += c - 4) > uploadQuota && uploadQuota != 0) {	// Hata Kontrolü: Yükleme kotasının aşılması
+		session->result = "quota exceeded";
+		tftp_server_send_error(session->socketFilDes, 3, "File exceeds upload quota", &session->client_socket, session->socketLength);
+		tftp_session_close(session);
+		return;
+	}
 
-				if (errno != EAGAIN) {	// EAGAIN hatası değilse transferi sonlandır (Resource temporarily unavailable ise gönderim tekrar denenecek)
-					printf("%s.%u: transfer killed\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-					exit(EXIT_FAILURE);
-				}
+	if (tftp_writer_append(session->writer, data, c - 4) < 0) {	// Gelen Data paketinin verisi dosyaya eklenir; disk yazımı yazma
+		tftp_log_errno("pwrite()");									// thread'inde yapıldığından ACK beklemeden gönderilir
+		session->result = "write failed";	// Hata Kontrolü: Gelen verinin yazılmasında hata
+		tftp_server_send_error(session->socketFilDes, 3, "Disk full or allocation exceeded", &session->client_socket, session->socketLength);
+		tftp_session_close(session);
+		return;
+	}
 
-				c = tftp_send_ack(socketFilDes, blockNumber, client_socket, socketLength);	// Server'dan Client'a ACK paketi gönderimi
+	if (!session->to_close && session->windowCount < session->windowSize) {	// Pencere dolmadıysa ACK gönderilmez, yalnızca
+		tftp_session_arm_timer(session);									// zaman aşımı ertelenir
+		return;
+	}
 
-				if (c < 0) {		// Hata Kontrolü: Paketin gönderilip gönderilemediğinin kontrolü
-					printf("%s.%u: transfer killed\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-					exit(EXIT_FAILURE);
-				}
-			}
+	session->windowCount = 0;
 
-			if (!countdownRetry) {	// 5 kez gönderim denenip başarısız olunduğunda transferi sonlandırmak için kullanılır
-				printf("%s.%u: transfer timed out\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-				exit(EXIT_FAILURE);
-			}
+	if (session->to_close) {	// Son blok: dosya diske kaydedilip asıl adına taşınana kadar son ACK bekletilir
+		tftp_timer_cancel(session);
+		session->state = SESSION_WRQ_FLUSH;
+		tftp_writer_finish(session->writer);
+		return;
+	}
 
-			blockNumber++;	// Verinin blok (paket) numarasının 1 artışı (counter)
-			printf("%s.%u: WRQ packet received. (%u)\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port), blockNumber);
+	tftp_session_transmit(session);	// Data paketlerinin alındığına dair Client'a ACK paketi gönderimi
+}
 
-			if (c < sizeof(message.data)) {
-				to_close = 1;
-			}
+// Yazma thread'inin bitirdiği dosyaların olay döngüsünde işlenmesi. Oturum hâlâ açıksa, dosya kaydedildiyse son ACK,
+// kaydedilemediyse ERROR paketi gönderilir ve oturum sonlandırılır. Yazma nesneleri burada serbest bırakılır.
+void tftp_writer_complete(void)
+{
+	tftpWriter *writer;
+	tftpWriter *next;
+	tftpSession *session;
+	uint64_t count;
 
-			if (ntohs(message.opcode) == ERROR) {	// Hata Kontrolü: Hata paketi geldiğinde transferi sonlandırır
-				printf("%s.%u: error message received: %u %s\n",
-						inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port),
-						ntohs(message.error.errorCode), message.error.errorMessage);
-				exit(EXIT_FAILURE);
-			}
+	if (read(writeEventFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+		tftp_log_errno("read()");
+	}
 
-			if (ntohs(message.opcode) != DATA) {	// Hata Kontrolü: Gelen paketin Data türünde olup olmadığının kontrolü
-				printf("%s.%u: invalid message during transfer received\n",
-						inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-				tftp_server_send_error(socketFilDes, 0, "Invalid message during transfer", client_socket, socketLength);
-				exit(EXIT_FAILURE);
+	pthread_mutex_lock(&writeMutex);
+	writer = writeDoneList;
+	writeDoneList = NULL;
+	pthread_mutex_unlock(&writeMutex);
+
+	for (; writer != NULL; writer = next) {
+		next = writer->doneNext;
+
+		if ((session = writer->session) != NULL) {
+			session->writer = NULL;
+			if (writer->error != 0) {
+				tftp_log(LOG_LEVEL_ERROR, "client=%s:%u event=save_failed file=\"%s\" error=\"%s\"",
+						session->clientAddr, ntohs(session->client_socket.sin_port), session->fileName, strerror(writer->error));
+				session->result = "write failed";
+				tftp_server_send_error(session->socketFilDes, 3, "Disk full or allocation exceeded", &session->client_socket, session->socketLength);
+			} else if (tftp_session_transmit(session) == 0) {	// Son bloğun ACK'sı
+				session->result = "ok";
 			}
+			tftp_session_close(session);
+		}
 
-			if (ntohs(message.ack.blockNumber) != blockNumber) {	// Hata Kontrolü: Gelen Data'daki blok numarası ile
-				printf("%s.%u: invalid block number received\n", 	// gönderilen ACK'nın blok numarasının uymaması
-						inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-				tftp_server_send_error(socketFilDes, 0, "Invalid block number", client_socket, socketLength);
-				exit(EXIT_FAILURE);
+		free(writer->fileName);
+		free(writer->tempName);
+		free(writer);
+	}
+}
+
+// Oturum soketi okunabilir olduğunda bekleyen tüm paketlerin alınıp oturumun ilerletilmesi
+void tftp_session_receive(tftpSession *session)
+{
+	tftpMessage ackMessage;				// RRQ'da gelen ACK/ERROR paketinin yazılacağı tampon (oturum tamponu son DATA'yı saklar)
+	tftpMessage *message;				// Gelen paketin yazılacağı tampon
+	size_t messageSize;					// Gelen paket tamponunun boyutu
+	uint8_t *data = NULL;				// WRQ: gelen DATA paketinin verisinin alındığı adres
+	struct sockaddr_in sender_socket;	// Paketi gönderenin adres bilgileri
+	socklen_t senderLength;
+	ssize_t c;							// Gelen paketin boyutu (bayt)
+
+	if (session->state == SESSION_WRQ_WAIT_DATA) {	// WRQ'da DATA paketleri doğrudan anlaşılan blok boyutundaki oturum tamponuna alınır
+		message = (tftpMessage *) session->buffer;
+		messageSize = session->blockSize + TFTP_DATA_MINIMUM;
+	} else {
+		message = &ackMessage;
+		messageSize = sizeof(ackMessage);
+	}
+
+	while (session->state != SESSION_CLOSED) {
+		senderLength = sizeof(sender_socket);
+
+		if (session->state == SESSION_WRQ_WAIT_DATA) {	// DATA'nın başlığı oturum tamponuna, verisi doğrudan yazma parçasına alınır
+			if ((data = tftp_writer_tail(session->writer)) == NULL) {
+				data = session->buffer + TFTP_DATA_MINIMUM;
+			}
+			c = tftp_receive_data(session->socketFilDes, session->buffer, data, session->blockSize, &sender_socket, &senderLength);
+			if (c > TFTP_DATA_MINIMUM && ntohs(message->opcode) != DATA && data != session->buffer + TFTP_DATA_MINIMUM) {
+				memmove(session->buffer + TFTP_DATA_MINIMUM, data, c - TFTP_DATA_MINIMUM);	// DATA dışındaki paketler tamponda birleştirilir
 			}
+		} else {
+			c = tftp_receive_message(session->socketFilDes, message, messageSize, &sender_socket, &senderLength);
+		}
 
-			c = fwrite(message.data.data, 1, c - 4, fd);	/* Belleğin data (tampon belleği) adresinden, 1'er bayt boyutunda, gelen Data paketinin
-								(bayt cinsinden) boyutunun 4 eksiği adedince veri, fp ile işaret edilen adrese yüklenir. Yazılan veri sayısını döndürür.*/
-			if (c < 0) {	// Hata Kontrolü: Gelen verinin yazılmasında hata
-				perror("server: fwrite()");
-				exit(EXIT_FAILURE);
+		if (c < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {	// EAGAIN hatası değilse transferi sonlandır (soket tamamen okunduysa sonraki olayı bekle)
+				session->result = "receive failed";
+				tftp_session_close(session);
 			}
+			return;
+		}
 
-			c = tftp_send_ack(socketFilDes, blockNumber, client_socket, socketLength);	// Data paketinin alındığına dair Client'a ACK paketi gönderimi
+		// Farklı bir adres/porttan gelen paket bu transfere ait değildir (RFC 1350, Transfer ID); transfer etkilenmez
+		if (sender_socket.sin_addr.s_addr != session->client_socket.sin_addr.s_addr ||
+				sender_socket.sin_port != session->client_socket.sin_port) {
+			tftp_server_send_error(session->socketFilDes, 5, "Unknown transfer ID", &sender_socket, senderLength);
+			continue;
+		}
 
-			if (c < 0) {	// Hata Kontrolü: ACK paketinin, gönderilip gönderilemediğinin kontrolü
-				printf("%s.%u: transfer killed\n", inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port));
-				exit(EXIT_FAILURE);
-			}
-		} // while(!to_close) bitiş
-		printf("\n%s.%u: DONE! Transfer completed with %u received packet(s).\n",	// Verinin başarıyla alındığına dair çıktı
-				inet_ntoa(client_socket->sin_addr), ntohs(client_socket->sin_port), blockNumber);
-	} // else if (opcode == WRQ) bitiş
+		if (c < 4) {	// Hata Kontrolü: Gelen paket boyutunun kontrolü
+			session->result = "invalid packet size";
+			tftp_server_send_error(session->socketFilDes, 0, "Invalid request size", &session->client_socket, session->socketLength);
+			tftp_session_close(session);
+			return;
+		}
 
-	fclose(fd);			// fd FILE nesnesi işaretçisiyle gösterilen dosya akışı kapatılır ve tampon bellekler temizlenir.
-	close(socketFilDes);	// Soketin sonlandırılması
+		if (ntohs(message->opcode) == ERROR) {		// Hata Kontrolü: Hata paketi geldiğinde transferi sonlandırır
+			((char *) message)[c < messageSize ? c : messageSize - 1] = '\0';
+			tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=peer_error code=%u message=\"%s\"",
+					session->clientAddr, ntohs(session->client_socket.sin_port),
+					ntohs(message->error.errorCode), message->error.errorMessage);
+			session->result = "peer error";
+			tftp_session_close(session);
+			return;
+		}
 
-	exit(EXIT_SUCCESS);
+		if (session->state == SESSION_RRQ_WAIT_ACK) {
+			tftp_session_handle_rrq(session, message);
+		} else if (session->state == SESSION_WRQ_WAIT_DATA) {
+			tftp_session_handle_wrq(session, message, data, c);
+		}	// SESSION_WRQ_FLUSH: dosya kaydedilirken gelen (tekrarlanan son DATA) paketler yok sayılır
+	}
 }
 
-// Client'tan Gelecek İsteklerin Beklenip Yönlendirileceği Fonksiyon
-int tftp_server_listen(int socketFilDes){
+// Zaman aşımı dolan oturumlarda son paketin yeniden gönderilmesi. Zaman aşımları tüm oturumların paylaştığı yığında tutulduğundan
+// yalnızca süresi dolan oturumlar işlenir. Bir sonraki zaman aşımına kalan süreyi (milisaniye, yukarı yuvarlanmış) döndürür;
+// epoll_wait() bu süre kadar bekler. Kurulu zamanlayıcı yoksa -1 (süresiz bekleme) döndürülür.
+int tftp_session_expire(void)
+{
+	tftpSession *session;
+	uint64_t now = tftp_time_now();
+
+	while (timerCount > 0 && timerHeap[0]->deadline <= now) {
+		session = timerHeap[0];
+		tftp_timer_cancel(session);
+		tftp_session_retransmit(session);	// Son paketin yeniden gönderimi (zamanlayıcı yeniden kurulur)
+	}
+
+	return timerCount == 0 ? -1 : (int) ((timerHeap[0]->deadline - now + 999) / 1000);
+}
+
+// Dinleme soketine gelen paketin işlenip yönlendirilmesi
+void tftp_server_dispatch(int socketFilDes, tftpMessage *message, ssize_t receivedMesSize, struct sockaddr_in *client_sock, socklen_t slen)
+{
+	uint16_t opcode;						// unsigned short int türünden işlem kodu değişkeni tanımlanması
+
+	if (receivedMesSize < TFTP_DATA_MINIMUM) {		// Hata Kontrolü: Gelen mesaj boyutunun minimum kabul edilen değere göre durumu
+		tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject reason=\"invalid request size\"",
+				inet_ntoa(client_sock->sin_addr), ntohs(client_sock->sin_port));	// Client ip&port bilgileri ile hata kaydı
+		tftp_server_send_error(socketFilDes, 0, "Invalid request size", client_sock, slen);
+		TFTP_METRIC_ADD(requestsRejected, 1);
+		return;
+	}
+
+	opcode = ntohs(message->opcode);
+
+	if (opcode == RRQ || opcode == WRQ) {	// Gelen mesajın okuma/yazma isteği paketi olup olmadığının kontrolü
+		if (activeSessions >= workerSessionLimit) {	// Hata Kontrolü: Worker'ın eşzamanlı oturum sınırına ulaşılması
+			tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject reason=\"server busy\"",
+					inet_ntoa(client_sock->sin_addr), ntohs(client_sock->sin_port));
+			tftp_server_send_error(socketFilDes, 0, "Server busy", client_sock, slen);
+			TFTP_METRIC_ADD(requestsRejected, 1);
+			return;
+		}
+		// Gelen istek için yeni bir oturum oluşturulur. Transfer olay döngüsü içinde ilerlediğinden dinleyici
+		// transferin bitmesini beklemeden bir sonraki isteği almaya döner.
+		tftp_server_handle_request(message, receivedMesSize, client_sock, slen);
+	}
+
+	else {		// Gelen paketin hatalı olma durumunda izlenecek adımlar
+		tftp_log(LOG_LEVEL_WARNING, "client=%s:%u event=reject reason=\"invalid opcode\" opcode=%u",
+				inet_ntoa(client_sock->sin_addr), ntohs(client_sock->sin_port), opcode);
+		tftp_server_send_error(socketFilDes, 0, "Invalid opcode", client_sock, slen);
+		TFTP_METRIC_ADD(requestsRejected, 1);
+	}
+}
+
+// Client'tan Gelecek İsteklerin Beklenip Yönlendirileceği Fonksiyon. Bekleyen istekler recvmmsg() ile TFTP_RECV_BATCH'lik
+// gruplar halinde tek sistem çağrısıyla alınır; çekirdek desteklemiyorsa tek tek alınır.
+void tftp_server_accept(int socketFilDes)
+{
+	tftpMessage messages[TFTP_RECV_BATCH];			// Gelen isteklerin yazılacağı tamponlar
+	struct sockaddr_in client_sock[TFTP_RECV_BATCH];	// İstekleri gönderen Client'ların adres bilgileri
+	struct iovec iov[TFTP_RECV_BATCH];
+	struct mmsghdr msgs[TFTP_RECV_BATCH];			// recvmmsg() için paket tanımları
+	socklen_t slen;
+	int received;		// Alınan istek sayısı
+	int i;
 
 	while (1) {
-		struct sockaddr_in client_sock;		// Client bilgilerinin yer alacağı struct'ın oluşturulması
-		socklen_t slen = sizeof(client_sock);	// Client soket struct'ının toplam kapladığı alanın unsigned int cinsinden kaydedilmesi
-		ssize_t receivedMesSize;				// Gelen mesaj uzunluğunun yer alacağı değişkenin tanımlanması (mesajın kaç bayt olduğu)
+		if (batchEnabled) {
+			for (i = 0; i < TFTP_RECV_BATCH; i++) {
+				iov[i].iov_base = &messages[i];
+				iov[i].iov_len = sizeof(messages[i]);
+				memset(&msgs[i], 0, sizeof(msgs[i]));
+				msgs[i].msg_hdr.msg_name = &client_sock[i];
+				msgs[i].msg_hdr.msg_namelen = sizeof(client_sock[i]);
+				msgs[i].msg_hdr.msg_iov = &iov[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
+			}
 
-		tftpMessage message;					// tftpMessage bileşimindeki veri türlerinin, fonksiyon içerisinde kullanıma hazır hale getirilmesi
-		uint16_t opcode;						// unsigned short int türünden işlem kodu değişkeni tanımlanması
+			if ((received = recvmmsg(socketFilDes, msgs, TFTP_RECV_BATCH, MSG_DONTWAIT, NULL)) < 0) {
+				if (errno == ENOSYS) {	// Çekirdek recvmmsg() desteklemiyor; tekli alıma geçilir
+					batchEnabled = 0;
+					continue;
+				}
+				if (errno != EAGAIN && errno != EWOULDBLOCK) {
+					tftp_log_errno("recvmmsg()");
+				}
+				return;		// Bekleyen paket kalmadıysa olay döngüsüne dönülür
+			}
+		}
+		else {
+			slen = sizeof(client_sock[0]);
+			if ((msgs[0].msg_len = tftp_receive_message(socketFilDes, &messages[0], sizeof(messages[0]), &client_sock[0], &slen)) == (unsigned int) -1) {
+				return;		// Bekleyen paket kalmadıysa olay döngüsüne dönülür
+			}
+			msgs[0].msg_hdr.msg_namelen = slen;
+			received = 1;
+		}
 
-		if ((receivedMesSize = tftp_receive_message(socketFilDes, &message, &client_sock, &slen)) < 0) {	// Gelen mesaj kontrolü. Cevap yoksa
-			continue;														// diğer işlemleri atlayıp döngünün başlangıcına dönülür
+		for (i = 0; i < received; i++) {
+			tftp_server_dispatch(socketFilDes, &messages[i], msgs[i].msg_len, &client_sock[i], msgs[i].msg_hdr.msg_namelen);
 		}
 
-		if (receivedMesSize < TFTP_DATA_MINIMUM) {		// Hata Kontrolü: Gelen mesaj boyutunun minimum kabul edilen değere göre durumu
-			printf("%s.%u: received packet with invalid size\n",
-					inet_ntoa(client_sock.sin_addr), ntohs(client_sock.sin_port));	// Client ip&port bilgileri ile hata mesajı bastırma
-			tftp_server_send_error(socketFilDes, 0, "Invalid request size", &client_sock, slen);
-			continue;
+		if (batchEnabled && received < TFTP_RECV_BATCH) {	// Soket boşaldı
+			return;
 		}
+	}
+}
+
+// Olay döngüsü: dinleme soketi ve tüm oturum soketleri tek bir epoll örneği üzerinden izlenir. Paket gelen
+// oturumlar ilerletilir, zaman aşımı dolan oturumlarda son paket yeniden gönderilir.
+int tftp_server_listen(int socketFilDes){
+
+	struct epoll_event events[TFTP_EVENT_BATCH];	// epoll_wait() ile alınan olaylar
+	struct epoll_event event;						// Dinleme soketinin kaydı için kullanılan struct
+	tftpSession *session;
+	int eventCount;
+	int timeout;	// epoll_wait() için milisaniye cinsinden bekleme süresi
+	int i;
 
-		opcode = ntohs(message.opcode);
+	if ((epollFilDes = epoll_create1(0)) < 0) {	// Hata Kontrolü: epoll örneğinin oluşturulması
+		tftp_log_errno("epoll_create1()");
+		return socketFilDes;
+	}
+
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;	// Dinleme soketi, oturum işaretçisi yerine NULL ile ayırt edilir
+
+	if (epoll_ctl(epollFilDes, EPOLL_CTL_ADD, socketFilDes, &event) < 0) {
+		tftp_log_errno("epoll_ctl()");
+		return socketFilDes;
+	}
+
+	if (tftp_writer_start() < 0) {	// WRQ verisini diske yazan thread'in başlatılması
+		return socketFilDes;
+	}
+
+	// Sayaç soketi yalnızca ilk worker tarafından sunulur; açılamazsa server sayaç çıktısı olmadan çalışır
+	if (workerIndex == 0 && metricsPath != NULL && tftp_metrics_start() < 0) {
+		metricsPath = NULL;
+	}
 
-		if (opcode == RRQ || opcode == WRQ) {	// Gelen mesajın okuma/yazma isteği paketi olup olmadığının kontrolü
-			// Gelen paket içeriği, oluşturulan child process'te okunur. Bu sırada parent process else'te child process'in sonlandırılmasını bekler
-			if (fork() == 0) {		// Child process'in girip işlem yaptığı blok
-				tftp_server_handle_request(&message, receivedMesSize, &client_sock, slen);	// Gelen mesajın işlenme adımı
-				exit(EXIT_SUCCESS);	// Parent process sonlandırılır ve child process, yeni parent process olarak çalışmaya devam eder
+	while (1) {
+		timeout = tftp_session_expire();	// Zaman aşımı dolan oturumların işlenmesi ve bir sonraki zaman aşımına kalan süre
+
+		if ((eventCount = epoll_wait(epollFilDes, events, TFTP_EVENT_BATCH, timeout)) < 0) {
+			if (errno == EINTR) {	// Sinyal ile kesilen bekleme yeniden başlatılır
+				continue;
 			}
-			else {		// Parent process'in girip child process'in sonlandırılmasını bekleyeceği blok
-				wait(NULL);
+			tftp_log_errno("epoll_wait()");
+			break;
+		}
+
+		for (i = 0; i < eventCount; i++) {
+			if (events[i].data.ptr == NULL) {	// Dinleme soketine yeni istek gelmesi
+				tftp_server_accept(socketFilDes);
+			} else if (events[i].data.ptr == &writeEventFd) {	// Yazma thread'inin dosya kaydını bitirmesi
+				tftp_writer_complete();
+			} else if (events[i].data.ptr == &metricsFilDes) {	// Sayaç soketine bağlantı gelmesi
+				tftp_metrics_serve();
+			} else {							// Bir oturumun soketine paket gelmesi
+				tftp_session_receive(events[i].data.ptr);
 			}
 		}
 
-		else {		// Gelen paketin hatalı olma durumunda izlenecek adımlar
-			printf("Invalid request received from %s.%u | opcode: \"%u\" \n",
-					inet_ntoa(client_sock.sin_addr), ntohs(client_sock.sin_port), opcode);
-			tftp_server_send_error(socketFilDes, 0, "Invalid opcode", &client_sock, slen);
+		while (closedSessionList != NULL) {	// Bu turda sonlandırılan oturumların bellekten silinmesi
+			session = closedSessionList;
+			closedSessionList = session->next;
+			free(session->fileName);
+			free(session->buffer);
+			free(session);
 		}
 	} // while(1){} bitiş
 
 	return socketFilDes;
 }
 
+// Worker thread'inin başlangıç fonksiyonu: thread kendi sayaç bloğunu seçer, işlemcisine sabitlenir ve kendi dinleme
+// soketiyle olay döngüsünü çalıştırır. Oturumlar, zamanlayıcılar ve önbellek thread'e özel olduğundan olay döngüsü
+// diğer worker'larla kilit paylaşmaz.
+void *tftp_worker_run(void *arg)
+{
+	tftpWorker *worker = arg;
+	cpu_set_t cpuSet;
+
+	workerIndex = worker->index;
+	threadMetrics = &metricsSlots[worker->index];
+
+	if (worker->cpu >= 0) {
+		CPU_ZERO(&cpuSet);
+		CPU_SET(worker->cpu, &cpuSet);
+		if ((errno = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet)) != 0) {
+			tftp_log_errno("pthread_setaffinity_np()");	// Sabitlenemeyen worker, zamanlayıcının seçtiği işlemcide çalışır
+		}
+	}
+
+	worker->socketFilDes = tftp_server_listen(worker->socketFilDes);
+
+	if (worker->index != 0) {	// Olay döngüsü yalnızca hata durumunda sonlanır
+		tftp_log(LOG_LEVEL_ERROR, "event=worker_stopped worker=%u", worker->index);
+	}
+
+	return NULL;
+}
+
+// Worker'ın sabitleneceği işlemci: process'in çalışabileceği işlemcilerden sıradaki. İşlemci kümesi okunamazsa -1 döndürür.
+int tftp_worker_cpu(unsigned int index)
+{
+	cpu_set_t cpuSet;
+	unsigned int count;
+	int cpu;
+
+	if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) < 0 || (count = CPU_COUNT(&cpuSet)) == 0) {
+		return -1;
+	}
+
+	index %= count;
+
+	for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+		if (CPU_ISSET(cpu, &cpuSet) && index-- == 0) {
+			return cpu;
+		}
+	}
+
+	return -1;
+}
+
 void tftp_ip_lister(){
 
 	#include <ifaddrs.h>
@@ -509,26 +2530,121 @@ void tftp_ip_lister(){
 // Main Fonksiyonu
 int main(int argc, char *argv[])
 {
+	tftpWorker workers[TFTP_WORKER_MAXIMUM];	// Worker'ların başlangıç bilgileri
+	cpu_set_t cpuSet;				// Process'in çalışabileceği işlemciler (-t 0 için)
 	int socketFilDes;				// Client dinlemede kullanılan soket (Socket File Descriptor)
+	int enable = 1;					// setsockopt() ile açılan soket seçenekleri için
+	unsigned int i;
 	uint16_t port = 0;				// Kullanılacak port numarasının değişken tanımlaması
 	struct protoent *pp;			// Protokol veritabanı bilgilerinin yer alacağı struct'ın oluşturulması
 	struct servent *ss;				// Servis veritabanı bilgilerinin yer alacağı struct'ın oluşturulması
 	struct sockaddr_in server_sock;	// Server Soket bilgilerinin yer alacağı struct'ın oluşturulması
+	struct rlimit fileLimit;		// Açık dosya betimleyicisi sınırının tutulduğu struct
+	int option;						// getopt() ile okunan seçenek karakteri
+	mode_t fileMask;				// Process'in dosya oluşturma maskesi (umask)
+
+	while ((option = getopt(argc, argv, "b:d:gl:M:m:n:q:s:t:w:")) != -1) {	// Seçeneklerin (argümanlardan önce verilen "-x değer" çiftleri) okunması
+		switch (option) {
+		case 'b':	// blksize seçeneği için server sınırı
+			if (sscanf(optarg, "%u", &blockSizeLimit) != 1 || blockSizeLimit < TFTP_BLKSIZE_MINIMUM || blockSizeLimit > TFTP_BLKSIZE_MAXIMUM) {
+				fprintf(stderr, "Server: invalid block size limit (%u-%u)\n", TFTP_BLKSIZE_MINIMUM, TFTP_BLKSIZE_MAXIMUM);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'd':	// WRQ dosyalarının diske kalıcı yazılma modu
+			if (strcmp(optarg, "never") == 0) {
+				writeDurability = DURABILITY_NEVER;
+			} else if (strcmp(optarg, "end") == 0) {
+				writeDurability = DURABILITY_END;
+			} else if (strcmp(optarg, "periodic") == 0) {
+				writeDurability = DURABILITY_PERIODIC;
+			} else {
+				fprintf(stderr, "Server: invalid durability mode (never, end, periodic)\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'g':	// Eşit boyutlu DATA paketlerinin UDP GSO ile gönderimi
+			gsoEnabled = 1;
+			break;
+		case 'l':	// Kayıt seviyesi
+			if (strcmp(optarg, "error") == 0) {
+				logLevel = LOG_LEVEL_ERROR;
+			} else if (strcmp(optarg, "warning") == 0) {
+				logLevel = LOG_LEVEL_WARNING;
+			} else if (strcmp(optarg, "info") == 0) {
+				logLevel = LOG_LEVEL_INFO;
+			} else if (strcmp(optarg, "debug") == 0) {
+				logLevel = LOG_LEVEL_DEBUG;
+			} else {
+				fprintf(stderr, "Server: invalid log level (error, warning, info, debug)\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'M':	// Sayaç soketinin yolu
+			metricsPath = optarg;
+			break;
+		case 'm':	// Dosya eşleme önbelleğinin boyut sınırı (MB)
+			if (sscanf(optarg, "%zu", &fileMapLimit) != 1) {
+				fprintf(stderr, "Server: invalid file cache size\n");
+				exit(EXIT_FAILURE);
+			}
+			fileMapLimit <<= 20;
+			break;
+		case 'n':	// Dosya eşleme önbelleğindeki en fazla dosya sayısı
+			if (sscanf(optarg, "%u", &fileMapEntryLimit) != 1) {
+				fprintf(stderr, "Server: invalid file cache entry limit\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'q':	// WRQ yükleme kotası (MB)
+			if (sscanf(optarg, "%" SCNu64, &uploadQuota) != 1) {
+				fprintf(stderr, "Server: invalid upload quota\n");
+				exit(EXIT_FAILURE);
+			}
+			uploadQuota <<= 20;
+			break;
+		case 's':	// Eşzamanlı oturum sınırı
+			if (sscanf(optarg, "%u", &maxSessions) != 1 || maxSessions == 0 || maxSessions > TFTP_SESSION_MAXIMUM) {
+				fprintf(stderr, "Server: invalid session limit (1-%u)\n", TFTP_SESSION_MAXIMUM);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 't':	// Worker (olay döngüsü thread'i) sayısı
+			if (sscanf(optarg, "%u", &workerCount) != 1 || workerCount > TFTP_WORKER_MAXIMUM) {
+				fprintf(stderr, "Server: invalid worker count (0-%u)\n", TFTP_WORKER_MAXIMUM);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'w':	// windowsize seçeneği için server sınırı
+			if (sscanf(optarg, "%u", &windowSizeLimit) != 1 || windowSizeLimit < 1 || windowSizeLimit > TFTP_WINDOWSIZE_MAXIMUM) {
+				fprintf(stderr, "Server: invalid window size limit (1-%u)\n", TFTP_WINDOWSIZE_MAXIMUM);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		default:
+			argc = 0;	// Tanınmayan seçenekte kullanım bilgisinin yazdırılması sağlanır
+			break;
+		}
+	}
 
-	if (argc < 2 || argc > 3) {	// Hata Kontrolü: Program başlangıcında girilen argüman sayısının kontrolü
-		printf("Usage:\n\t%s [base directory] [port number]\n", argv[0]);
+	if (argc - optind < 1 || argc - optind > 2) {	// Hata Kontrolü: Program başlangıcında girilen argüman sayısının kontrolü
+		printf("Usage:\n\t%s [-b max blksize] [-d never|end|periodic] [-g] [-l log level] [-M metrics socket] [-m cache MB] [-n cache files] [-q quota MB] [-s max sessions] [-t workers] [-w max windowsize] [base directory] [port number]\n", argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
-	fileBaseDirectory = argv[1];	// Server'ın kullanacağı ana dizinin, kullanıcıdan gelen argümanla tanımlanması
+	fileMask = umask(0);	// fopen() ile oluşturulan dosyalarla aynı izinler için umask okunur
+	umask(fileMask);
+	fileCreateMode = 0666 & ~fileMask;
+
+	fileBaseDirectory = argv[optind];	// Server'ın kullanacağı ana dizinin, kullanıcıdan gelen argümanla tanımlanması
 
 	if (chdir(fileBaseDirectory) < 0) {	// Hata Kontrolü: Geçerli dizinin, girilen dizinle değiştirilip geçerliliğinin kontrolü
 		perror("Server: chdir()");
 		exit(EXIT_FAILURE);
 	}
 
-	if (argc > 2) {	// Programa başlangıçta ana dizin ve port numarasının girilmesi halinde yapılacak eylemler
-		if (sscanf(argv[2], "%hu", &port)) { // Hata Kontrolü: Programa başlangıçta girilen port no'nun kaydı | Fonk. parametre sayısını döndürür
+	if (argc - optind > 1) {	// Programa başlangıçta ana dizin ve port numarasının girilmesi halinde yapılacak eylemler
+		if (sscanf(argv[optind + 1], "%hu", &port)) { // Hata Kontrolü: Programa başlangıçta girilen port no'nun kaydı | Fonk. parametre sayısını döndürür
 			port = htons(port);	// Port numarası verisinin ağ bayt sıralamasına çevrilip kaydedilmesi
 		} else {	// Hata kontrolü: Programa girilen port numarası argümanının hatalı olması durumu
 			fprintf(stderr, "Server: invalid port number\n");
@@ -546,34 +2662,81 @@ int main(int argc, char *argv[])
 		exit(EXIT_FAILURE);
 	}
 
-	if ((socketFilDes = socket(AF_INET, SOCK_DGRAM, pp->p_proto)) == -1) {	// Hata Kontrolü: Soket oluşturulması ve hata durumunun kontrolü
-		perror("Server: socket() error");
-		exit(EXIT_FAILURE);
+	// Her oturum kendi soketini kullandığından açık dosya betimleyicisi sınırı, izin verilen en yüksek değere çekilir
+	if (getrlimit(RLIMIT_NOFILE, &fileLimit) == 0 && fileLimit.rlim_cur < fileLimit.rlim_max) {
+		fileLimit.rlim_cur = fileLimit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &fileLimit);
 	}
 
+	if (workerCount == 0) {	// -t 0: process'in çalışabileceği her işlemci için bir worker
+		workerCount = sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0 ? CPU_COUNT(&cpuSet) : 1;
+		workerCount = workerCount > TFTP_WORKER_MAXIMUM ? TFTP_WORKER_MAXIMUM : workerCount;
+	}
+
+	metricsSlotCount = workerCount;
+	workerSessionLimit = (maxSessions + workerCount - 1) / workerCount;	// Oturum sınırı worker'lara eşit bölünür
+
 	// Server ağ ayarlarının tanımlanması
 	server_sock.sin_family = AF_INET;				// Soket için kullanılan iletişim protokolü ailesi (IPv4)
 	server_sock.sin_addr.s_addr = htonl(INADDR_ANY);	// Soketin tüm yerel arabirimlere bağlanacağının belirtilmesi
 	server_sock.sin_port = port ? port : ss->s_port;	// Kullanılacak port numarasının atanması
 
-	// Hata Kontrolü: Soketin belirlenen ip adresi ve port numarası ile ilişkilendirilip hata kontrolünün yapılması
-	// bind() fonksiyonu hata halinde "-1" değerini döndürmektedir.
-	if (bind(socketFilDes, (struct sockaddr *) &server_sock, sizeof(server_sock)) == -1) {
-		perror("Server: bind()");
-		puts("Hint: You can try with sudo or a different port number.");
-		close(socketFilDes);		// Soketin sonlandırılması
-		exit(EXIT_FAILURE);
+	// Her worker için aynı porta bağlanan ayrı bir dinleme soketi açılır; SO_REUSEPORT ile çekirdek gelen istekleri
+	// client adresine göre soketlere dağıtır. Tüm soketler worker'lar başlamadan bağlanır, böylece bind() hatası
+	// başlangıçta bildirilir.
+	for (i = 0; i < workerCount; i++) {
+		if ((socketFilDes = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, pp->p_proto)) == -1) {	// Hata Kontrolü: Soket oluşturulması ve hata durumunun kontrolü
+			perror("Server: socket() error");
+			exit(EXIT_FAILURE);
+		}
+
+		if (workerCount > 1 && setsockopt(socketFilDes, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+			perror("Server: setsockopt(SO_REUSEPORT)");
+			exit(EXIT_FAILURE);
+		}
+
+		workers[i].index = i;
+		workers[i].socketFilDes = socketFilDes;
+		workers[i].cpu = workerCount > 1 ? tftp_worker_cpu(i) : -1;	// Tek worker'da zamanlayıcı serbest bırakılır
+
+		if (workers[i].cpu >= 0) {	// Paketin işlendiği işlemci ile worker'ın işlemcisinin eşlenmesi (desteklenmiyorsa yok sayılır)
+			setsockopt(socketFilDes, SOL_SOCKET, SO_INCOMING_CPU, &workers[i].cpu, sizeof(workers[i].cpu));
+		}
+
+		// Hata Kontrolü: Soketin belirlenen ip adresi ve port numarası ile ilişkilendirilip hata kontrolünün yapılması
+		// bind() fonksiyonu hata halinde "-1" değerini döndürmektedir.
+		if (bind(socketFilDes, (struct sockaddr *) &server_sock, sizeof(server_sock)) == -1) {
+			perror("Server: bind()");
+			puts("Hint: You can try with sudo or a different port number.");
+			close(socketFilDes);		// Soketin sonlandırılması
+			exit(EXIT_FAILURE);
+		}
 	}
 
 	printf("\nTFTP Server: listening on %d\n", ntohs(server_sock.sin_port));
 
 	tftp_ip_lister();
 
+	printf("Serving up to %u concurrent transfers on %u worker%s.\n", maxSessions, workerCount, workerCount > 1 ? "s" : "");
+
 	puts("You can exit the program with Ctrl+C.");
 
-	socketFilDes = tftp_server_listen(socketFilDes);
+	tftp_log_start();	// Kayıtlar bu noktadan sonra kayıt thread'i tarafından yazılır
 
-	close(socketFilDes);	// Soketin sonlandırılması
+	for (i = 1; i < workerCount; i++) {	// İlk worker main thread'inde çalışır
+		if ((errno = pthread_create(&workers[i].thread, NULL, tftp_worker_run, &workers[i])) != 0) {
+			perror("Server: pthread_create()");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	tftp_worker_run(&workers[0]);
+
+	tftp_log_stop();
+
+	for (i = 0; i < workerCount; i++) {
+		close(workers[i].socketFilDes);	// Soketlerin sonlandırılması
+	}
 
 	return 0;
 }
\ No newline at end of file